@@ -0,0 +1,231 @@
+// NOLINTBEGIN
+// IMPLEMENTATION DEFINITIONS
+#define RYCE_IMPL
+
+// OVERRIDES / ENABLED FEATURES
+#define RYCE_WIDE_CHAR_SUPPORT
+
+#include "tui.h"
+#include "vterm.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+    Renderer benchmark.
+
+    Replays scripted frames through the TUI into the in-memory virtual terminal and reports the render time, the
+    output size and the number of escape sequences per frame. Every frame is checked against the update buffer.
+
+    USAGE: ryce_bench [width height [frames]]
+*/
+
+// --- Constants --------------------------------------------------------- //
+const uint32_t DEFAULT_WIDTH = 200;
+const uint32_t DEFAULT_HEIGHT = 60;
+const uint32_t DEFAULT_FRAMES = 600;
+const uint32_t SPRITE_COUNT = 64;
+const double CHURN_RATIO = 0.1;
+
+// --- Glyphs ------------------------------------------------------------ //
+RYCE_Glyph TERRAIN[] = {
+    {.ch = RYCE_LITERAL('~'), .style = {.part = {.fg_color = RYCE_STYLE_COLOR_BLUE}}},
+    {.ch = RYCE_LITERAL('.'), .style = {.part = {.fg_color = RYCE_STYLE_COLOR_YELLOW}}},
+    {.ch = RYCE_LITERAL(','), .style = {.part = {.fg_color = RYCE_STYLE_COLOR_GREEN}}},
+    {.ch = RYCE_LITERAL(','), .style = {.part = {.fg_color = RYCE_STYLE_COLOR_GREEN}}},
+    {.ch = RYCE_LITERAL('T'),
+     .style = {.part = {.fg_color = RYCE_STYLE_COLOR_GREEN, .style_flags = RYCE_STYLE_MODIFIER_BOLD}}},
+    {.ch = L'▲', .style = {.part = {.fg_color = RYCE_STYLE_COLOR_WHITE, .style_flags = RYCE_STYLE_MODIFIER_DIM}}},
+    {.ch = RYCE_LITERAL(' '), .style = {.part = {.bg_color = RYCE_STYLE_COLOR_BLUE}}},
+};
+
+RYCE_Glyph SPRITE = {.ch = RYCE_LITERAL('@'),
+                     .style = {.part = {.fg_color = RYCE_STYLE_COLOR_RED, .style_flags = RYCE_STYLE_MODIFIER_BOLD}}};
+
+// --- Benchmark state --------------------------------------------------- //
+typedef struct Bench {
+    RYCE_TuiContext tui;
+    RYCE_VTerm vterm;
+    RYCE_Pane pane;
+    RYCE_Glyph *glyphs;
+    uint32_t width;
+    uint32_t height;
+    int64_t sink_ns;
+} Bench;
+
+typedef struct Scenario {
+    const char *name;
+    void (*frame)(Bench *bench, uint32_t frame);
+} Scenario;
+
+int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t)ts.tv_sec * 1000000000L) + ts.tv_nsec;
+}
+
+uint32_t hash(int64_t x, int64_t y) {
+    uint64_t h = ((uint64_t)x * 0x9E3779B97F4A7C15ULL) ^ ((uint64_t)y * 0xC2B2AE3D27D4EB4FULL);
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+RYCE_Glyph terrain(int64_t x, int64_t y) {
+    // Blocky patches produce the long runs of open terrain.
+    const int64_t bx = x >= 0 ? x / 7 : ((x + 1) / 7) - 1;
+    const int64_t by = y >= 0 ? y / 4 : ((y + 1) / 4) - 1;
+    uint32_t kind = hash(bx, by) % RYCE_ARRAY_LEN(TERRAIN);
+    if (kind == 4 && hash(x, y) % 3 != 0) {
+        // Forests are sparse.
+        kind = 2;
+    }
+
+    return TERRAIN[kind];
+}
+
+void draw_terrain(Bench *bench, int64_t cx, int64_t cy) {
+    for (uint32_t y = 0; y < bench->height; y++) {
+        for (uint32_t x = 0; x < bench->width; x++) {
+            bench->glyphs[(y * bench->width) + x] = terrain(cx + x, cy + y);
+        }
+    }
+
+    ryce_pane_blit(&bench->pane, 0, 0, bench->width, bench->height, bench->glyphs, bench->width);
+}
+
+// --- Scenarios --------------------------------------------------------- //
+void frame_static(Bench *bench, uint32_t frame) {
+    // Nothing moves, measures the cost of an idle frame.
+    RYCE_UNUSED(frame);
+    draw_terrain(bench, 0, 0);
+}
+
+void camera_position(uint32_t frame, int64_t *x, int64_t *y) {
+    // Walk right, then down, then diagonally, one cell per frame.
+    const uint32_t leg = frame % 300;
+    *x = leg < 100 ? leg : (leg < 200 ? 100 : 100 + (leg - 200));
+    *y = leg < 100 ? 0 : (leg < 200 ? leg - 100 : 100 + (leg - 200));
+    *x += (frame / 300) * 200;
+    *y += (frame / 300) * 200;
+}
+
+void frame_pan(Bench *bench, uint32_t frame) {
+    int64_t x = 0;
+    int64_t y = 0;
+    int64_t px = 0;
+    int64_t py = 0;
+    camera_position(frame, &x, &y);
+    camera_position(frame > 0 ? frame - 1 : 0, &px, &py);
+
+    ryce_pane_scroll(&bench->pane, (int32_t)(px - x), (int32_t)(py - y));
+    draw_terrain(bench, x, y);
+    ryce_pane_set(&bench->pane, bench->width / 2, bench->height / 2, &SPRITE);
+}
+
+void frame_sprites(Bench *bench, uint32_t frame) {
+    draw_terrain(bench, 0, 0);
+    for (uint32_t i = 0; i < SPRITE_COUNT; i++) {
+        // Each sprite walks its own lap around the screen.
+        const uint32_t x = (hash(i, 0) + frame) % bench->width;
+        const uint32_t y = (hash(i, 1) + (frame / 2)) % bench->height;
+        ryce_pane_set(&bench->pane, x, y, &SPRITE);
+    }
+}
+
+void frame_churn(Bench *bench, uint32_t frame) {
+    // Worst case, scattered cells change every frame.
+    const uint32_t changes = (uint32_t)(bench->width * bench->height * CHURN_RATIO);
+    for (uint32_t i = 0; i < changes; i++) {
+        const uint32_t h = hash(frame, i);
+        const RYCE_Glyph *glyph = &TERRAIN[(h >> 24) % RYCE_ARRAY_LEN(TERRAIN)];
+        ryce_pane_set(&bench->pane, h % bench->width, (h >> 12) % bench->height, glyph);
+    }
+}
+
+const Scenario SCENARIOS[] = {
+    {"static", frame_static},
+    {"pan", frame_pan},
+    {"sprites", frame_sprites},
+    {"churn", frame_churn},
+};
+
+// --- Runner ------------------------------------------------------------ //
+RYCE_TuiError timed_sink(void *user, const char *buffer, size_t length) {
+    // Parsing is not part of the renderer, keep its time out of the results.
+    Bench *bench = (Bench *)user;
+    const int64_t start = now_ns();
+    ryce_vterm_feed(&bench->vterm, buffer, length);
+    bench->sink_ns += now_ns() - start;
+    return RYCE_TUI_ERR_NONE;
+}
+
+int run(const Scenario *scenario, uint32_t width, uint32_t height, uint32_t frames) {
+    Bench bench = {.width = width, .height = height};
+    bench.glyphs = (RYCE_Glyph *)malloc((size_t)width * height * sizeof(RYCE_Glyph));
+    if (bench.glyphs == nullptr || ryce_init_tui_ctx(width, height, &bench.tui) != RYCE_TUI_ERR_NONE ||
+        ryce_init_vterm(width, height, &bench.vterm) != RYCE_VTERM_ERR_NONE ||
+        ryce_init_pane(0, 0, width, height, &bench.tui, &bench.pane) != RYCE_TUI_ERR_NONE) {
+        fprintf(stderr, "Failed to set up scenario %s.\n", scenario->name);
+        return 1;
+    }
+
+    ryce_tui_set_sink(&bench.tui, timed_sink, &bench);
+    ryce_tui_set_rep(&bench.tui, true); // The virtual terminal implements REP.
+
+    // Draw the first frame outside the measurement, it always repaints the whole screen.
+    scenario->frame(&bench, 0);
+    RYCE_TuiError error = ryce_render_tui(&bench.tui);
+    const uint64_t bytes = bench.vterm.stats.bytes;
+    const uint64_t sequences = bench.vterm.stats.sequences;
+    bench.sink_ns = 0;
+
+    int64_t elapsed = 0;
+    uint32_t mismatched = 0;
+    for (uint32_t frame = 1; frame <= frames && error == RYCE_TUI_ERR_NONE; frame++) {
+        scenario->frame(&bench, frame);
+
+        const int64_t start = now_ns();
+        error = ryce_render_tui(&bench.tui);
+        elapsed += now_ns() - start;
+
+        if (ryce_vterm_compare(&bench.vterm, bench.tui.update) != 0) {
+            mismatched++;
+        }
+    }
+
+    if (error != RYCE_TUI_ERR_NONE) {
+        fprintf(stderr, "Failed to render scenario %s: %d\n", scenario->name, error);
+    }
+
+    printf("%-10s %12.0f %14.1f %14.1f %10u\n", scenario->name, (double)(elapsed - bench.sink_ns) / frames,
+           (double)(bench.vterm.stats.bytes - bytes) / frames,
+           (double)(bench.vterm.stats.sequences - sequences) / frames, mismatched);
+
+    ryce_vterm_free(&bench.vterm);
+    ryce_tui_free_ctx(&bench.tui);
+    free(bench.glyphs);
+    return error != RYCE_TUI_ERR_NONE || mismatched != 0;
+}
+
+int main(int argc, char **argv) {
+    const uint32_t width = argc > 2 ? (uint32_t)strtoul(argv[1], nullptr, 10) : DEFAULT_WIDTH;
+    const uint32_t height = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 10) : DEFAULT_HEIGHT;
+    const uint32_t frames = argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 10) : DEFAULT_FRAMES;
+    if ((argc != 1 && argc != 3 && argc != 4) || width == 0 || height == 0 || frames == 0) {
+        fprintf(stderr, "Usage: %s [width height [frames]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("%ux%u, %u frames\n", width, height, frames);
+    printf("%-10s %12s %14s %14s %10s\n", "scenario", "ns/frame", "bytes/frame", "seqs/frame", "mismatch");
+
+    int failed = 0;
+    for (size_t i = 0; i < RYCE_ARRAY_LEN(SCENARIOS); i++) {
+        failed |= run(&SCENARIOS[i], width, height, frames);
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+// NOLINTEND
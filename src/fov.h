@@ -19,6 +19,8 @@
 */
 #define RYCE_FOV_H
 
+#include "grid.h" // ryce_grid_idx, RYCE_GRID_LEN
+#include <stddef.h>
 #include <stdint.h>
 
 // ---------------------------------------------------------------------//
@@ -70,8 +72,8 @@ typedef enum {
  * @param origin_x X-coordinate of the origin point.
  * @param origin_y Y-coordinate of the origin point.
  * @param radius Radius of the light circle.
- * @param src Pointer to the pathing / blocked map.
- * @param dst Pointer to the visibility map.
+ * @param src Pointer to the pathing / blocked map, laid out as described by `ryce_grid_idx`.
+ * @param dst Pointer to the visibility map, laid out as described by `ryce_grid_idx`.
  * @param width Width of the map.
  * @param height Height of the map.
  * @return RYCE_FovError Error code indicating success or failure.
@@ -142,12 +144,12 @@ RYCE_PRIVATE RYCE_FovError ryce_fov_cast_light_internal(int32_t cx, int32_t cy,
         int32_t rad2 = radius * radius;
         if ((dx * dx + dy * dy) <= rad2) {
             // Mark it visible and seen.
-            out[(map_y * width) + map_x] |= (RYCE_FOV_VISIBLE | RYCE_FOV_SEEN);
+            out[ryce_grid_idx(map_x, map_y, width)] |= (RYCE_FOV_VISIBLE | RYCE_FOV_SEEN);
         }
 
         if (blocked) {
             // We are scanning through a shadow
-            if (map[(map_y * width) + map_x] == RYCE_OPAQUE_VALUE) {
+            if (map[ryce_grid_idx(map_x, map_y, width)] == RYCE_OPAQUE_VALUE) {
                 new_start_slope = r_slope;
                 continue;
             } else {
@@ -155,7 +157,7 @@ RYCE_PRIVATE RYCE_FovError ryce_fov_cast_light_internal(int32_t cx, int32_t cy,
                 start_slope = new_start_slope;
             }
         } else {
-            if (map[(map_y * width) + map_x] == RYCE_OPAQUE_VALUE && row < radius) {
+            if (map[ryce_grid_idx(map_x, map_y, width)] == RYCE_OPAQUE_VALUE && row < radius) {
                 blocked = 1;
                 // Recurse for the blocked area.
                 ryce_fov_cast_light_internal(cx, cy, radius, row + 1, start_slope, r_slope, map, out, width, height, xx,
@@ -0,0 +1,80 @@
+#ifndef RYCE_GRID_H
+/*
+    RyCE Grid - Header-only Z-order (Morton) and grid layout helpers shared by vec.h, fov.h and map.h.
+
+    USAGE:
+
+    Just #include "grid.h", every helper is static inline so there is no implementation section.
+*/
+#define RYCE_GRID_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ---------------------------------------------------------------------//
+// BEGIN VISIBILITY MACROS
+#ifndef RYCE_PRIVATE
+#if defined(__GNUC__) || defined(__clang__)
+#define RYCE_PRIVATE __attribute__((unused)) static
+#else
+#define RYCE_PRIVATE static
+#endif
+#endif // RYCE_PRIVATE
+// END VISIBILITY MACROS
+// ---------------------------------------------------------------------//
+
+#ifndef RYCE_VEC2
+#define RYCE_VEC2
+typedef struct RYCE_Vec2 {
+    int64_t x; // X-coordinate.
+    int64_t y; // Y-coordinate.
+} RYCE_Vec2;
+#endif // RYCE_VEC2
+
+// Z-order (Morton) codes interleave the bits of X (even bits) and Y (odd bits), so cells close in 2D stay close in
+// memory.
+RYCE_PRIVATE inline uint64_t ryce_morton_spread_internal(const uint32_t value) {
+    uint64_t bits = value;
+    bits = (bits | (bits << 16)) & 0x0000FFFF0000FFFFULL;
+    bits = (bits | (bits << 8)) & 0x00FF00FF00FF00FFULL;
+    bits = (bits | (bits << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    bits = (bits | (bits << 2)) & 0x3333333333333333ULL;
+    bits = (bits | (bits << 1)) & 0x5555555555555555ULL;
+    return bits;
+}
+
+RYCE_PRIVATE inline uint64_t ryce_morton_encode2(const uint32_t x, const uint32_t y) {
+    return ryce_morton_spread_internal(x) | (ryce_morton_spread_internal(y) << 1);
+}
+
+RYCE_PRIVATE inline uint32_t ryce_morton_compact_internal(uint64_t bits) {
+    bits &= 0x5555555555555555ULL;
+    bits = (bits | (bits >> 1)) & 0x3333333333333333ULL;
+    bits = (bits | (bits >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+    bits = (bits | (bits >> 4)) & 0x00FF00FF00FF00FFULL;
+    bits = (bits | (bits >> 8)) & 0x0000FFFF0000FFFFULL;
+    bits = (bits | (bits >> 16)) & 0x00000000FFFFFFFFULL;
+    return (uint32_t)bits;
+}
+
+// Inverse of ryce_morton_encode2.
+RYCE_PRIVATE inline RYCE_Vec2 ryce_morton_decode2(const uint64_t code) {
+    return (RYCE_Vec2){.x = ryce_morton_compact_internal(code), .y = ryce_morton_compact_internal(code >> 1)};
+}
+
+// Byte grids (FOV, paths) are row-major, or with RYCE_GRID_TILED stored as 8x8 tiles of one cache line each, tiles
+// row-major and cells in Z-order inside a tile. Size grids with RYCE_GRID_LEN and index them with ryce_grid_idx.
+#ifdef RYCE_GRID_TILED
+#define RYCE_GRID_LEN(width, height) ((((width) + 7) / 8) * (((height) + 7) / 8) * 64)
+RYCE_PRIVATE inline size_t ryce_grid_idx(const uint32_t x, const uint32_t y, const uint32_t width) {
+    const size_t tile = ((size_t)(y >> 3) * ((width + 7) >> 3)) + (x >> 3);
+    return (tile << 6) + (size_t)ryce_morton_encode2(x & 7, y & 7);
+}
+#else
+#define RYCE_GRID_LEN(width, height) ((width) * (height))
+RYCE_PRIVATE inline size_t ryce_grid_idx(const uint32_t x, const uint32_t y, const uint32_t width) {
+    return ((size_t)y * width) + x;
+}
+#endif // RYCE_GRID_TILED
+
+#endif // RYCE_GRID_H
@@ -14,6 +14,7 @@
 #include "loop.h"
 #include "map.h"
 #include "simplex.h"
+#include "spatial.h"
 #include "tui.h"
 #include "vec.h"
 #include <float.h>
@@ -35,9 +36,12 @@
 const size_t ALPHABET_SIZE = 26;
 const double SCREEN_CHANGES = 0.0005;
 const int TICKS_PER_SECOND = 512;
+const int FRAMES_PER_SECOND = 60;
 const int DIST_PER_SECOND = 20; // Amount of blocks that can be traveled per second.
 const int TICK_INTERVAL = 1000000 / TICKS_PER_SECOND;
 const float64_t SCALE = 0.025;
+const uint32_t DEBUG_WIDTH = 30; // Width of the debug pane.
+const uint32_t DEBUG_HEIGHT = 7; // Height of the debug pane.
 
 // --- Interrupt Handler ------------------------------------------------- //
 volatile sig_atomic_t lock = 0;
@@ -46,6 +50,13 @@ void handle_sigint(int sig) {
     lock = 1;
 }
 
+// --- Resize Handler ---------------------------------------------------- //
+volatile sig_atomic_t resized = 0;
+void handle_sigwinch(int sig) {
+    (void)sig;
+    resized = 1;
+}
+
 // --- Entity ------------------------------------------------------------ //
 enum EntityAttributes {
     ATTR_NONE = 0,
@@ -71,9 +82,17 @@ typedef struct AppState {
     } panes;
     struct {
         RYCE_3dTextMap entity;
-        uint8_t visiblity[MAP_MAX_X * MAP_MAX_Y];
-        uint8_t path[MAP_MAX_X * MAP_MAX_Y];
+        uint8_t visiblity[RYCE_GRID_LEN(MAP_MAX_X, MAP_MAX_Y)];
+        uint8_t path[RYCE_GRID_LEN(MAP_MAX_X, MAP_MAX_Y)];
+        uint64_t path_cursor; // Map journal sequence the path grid is up to date with.
+        RYCE_SpatialHash actors;
     } maps;
+    struct {
+        RYCE_Glyph *glyphs;
+        size_t capacity;
+        RYCE_SpatialHandle *actors;
+        size_t actor_capacity;
+    } draw;
     Entity *entities;
     size_t entity_count;
     struct {
@@ -82,6 +101,7 @@ typedef struct AppState {
         RYCE_Vec2 view;
         RYCE_BLA_Error move_error;
         uint32_t last_move;
+        RYCE_SpatialHandle handle;
     } player;
 } AppState;
 
@@ -127,9 +147,75 @@ RYCE_Glyph GLYPHS[] = {
 
 };
 
+// --- Path Grid --------------------------------------------------------- //
+// Marks a map column as blocked when its top entity is solid.
+void update_path_cell(AppState *app, int64_t x, int64_t y) {
+    RYCE_3dTextMap *map = &app->maps.entity;
+    RYCE_Vec3 column = {.x = x, .y = y, .z = 0};
+    RYCE_Vec3 top;
+    RYCE_EntityID entity = RYCE_ENTITY_NONE;
+    if (ryce_map_get_top(map, &column, &top) == RYCE_MAP_ERR_NONE) {
+        entity = ryce_map_get_entity(map, &top);
+    }
+
+    uint32_t tx = x - map->x.min;
+    uint32_t ty = y - map->y.min;
+    app->maps.path[ryce_grid_idx(tx, ty, map->length)] = (app->entities[entity].attr & ATTR_SOLID) ? 0 : 1;
+}
+
+// Derives the whole grid a row at a time, scanning the levels down until every column has its top entity.
+void rebuild_path(AppState *app) {
+    RYCE_3dTextMap *map = &app->maps.entity;
+    RYCE_EntityID row[MAP_MAX_X];
+    RYCE_EntityID tops[MAP_MAX_X];
+    for (int64_t y = map->y.min; y <= map->y.max; y++) {
+        size_t open = map->length;
+        for (size_t x = 0; x < map->length; x++) {
+            tops[x] = RYCE_ENTITY_NONE;
+        }
+
+        for (int64_t z = map->z.max; z >= map->z.min && open > 0; z--) {
+            RYCE_Vec3 start = {.x = map->x.min, .y = y, .z = z};
+            ryce_map_get_row(map, &start, map->length, row);
+            for (size_t x = 0; x < map->length; x++) {
+                if (tops[x] == RYCE_ENTITY_NONE && row[x] != RYCE_ENTITY_NONE) {
+                    tops[x] = row[x];
+                    open--;
+                }
+            }
+        }
+
+        uint32_t ty = y - map->y.min;
+        for (size_t x = 0; x < map->length; x++) {
+            app->maps.path[ryce_grid_idx(x, ty, map->length)] = (app->entities[tops[x]].attr & ATTR_SOLID) ? 0 : 1;
+        }
+    }
+
+    app->maps.path_cursor = ryce_map_journal_head(map);
+}
+
+// Replays the map changes made since the path grid was last updated.
+void update_path(AppState *app) {
+    RYCE_MapChange changes[64];
+    size_t count = 0;
+    RYCE_MapError err_code = RYCE_MAP_ERR_NONE;
+    do {
+        err_code = ryce_map_read_changes(&app->maps.entity, &app->maps.path_cursor, changes, 64, &count);
+        if (err_code == RYCE_MAP_JOURNAL_OVERRUN) {
+            // Fell too far behind, derive the whole grid again.
+            rebuild_path(app);
+            return;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            update_path_cell(app, changes[i].pos.x, changes[i].pos.y);
+        }
+    } while (err_code == RYCE_MAP_ERR_NONE && count == 64);
+}
+
 // --- Initializers ------------------------------------------------------ //
 void init_entities(AppState *app) {
-    app->entity_count = 6;
+    app->entity_count = 7;
     app->entities = (Entity *)malloc(app->entity_count * sizeof(Entity));
     app->entities[0] = (Entity){.id = 0, .glyph = &GLYPHS[0], .attr = ATTR_NONE};
     app->entities[1] = (Entity){.id = 1, .glyph = &GLYPHS[1], .attr = ATTR_NONE};
@@ -137,6 +223,7 @@ void init_entities(AppState *app) {
     app->entities[3] = (Entity){.id = 3, .glyph = &GLYPHS[3], .attr = ATTR_WALKABLE};
     app->entities[4] = (Entity){.id = 4, .glyph = &GLYPHS[4], .attr = ATTR_SOLID};
     app->entities[5] = (Entity){.id = 5, .glyph = &GLYPHS[5], .attr = ATTR_SOLID};
+    app->entities[6] = (Entity){.id = 6, .glyph = &GLYPHS[6], .attr = ATTR_NONE}; // Player
 }
 
 void init_map(AppState *app) {
@@ -168,17 +255,12 @@ void init_map(AppState *app) {
                 entity = 5; // Mountain
             }
 
-            int32_t tx = x + -map->x.min;
-            int32_t ty = y + -map->y.min;
-            if (app->entities[entity].attr & ATTR_SOLID) {
-                app->maps.path[tx + (ty * app->maps.entity.length)] = 0;
-            } else {
-                app->maps.path[tx + (ty * app->maps.entity.length)] = 1;
-            }
-
             ryce_map_add_entity(map, &vec, entity);
         }
     }
+
+    // Derive the path grid once, later edits reach it through the map's journal.
+    rebuild_path(app);
 }
 
 RYCE_Vec3 init_player(AppState *app) {
@@ -188,7 +270,9 @@ RYCE_Vec3 init_player(AppState *app) {
             RYCE_Vec3 vec = {.x = x, .y = y, .z = 0};
             RYCE_EntityID entity = ryce_map_get_entity(&app->maps.entity, &vec);
             if (app->entities[entity].attr & ATTR_WALKABLE) {
-                app->maps.visiblity[vec.x + (vec.y * app->maps.entity.x.max)] = 3;
+                uint32_t vx = vec.x + app->maps.entity.x.max;
+                uint32_t vy = vec.y + app->maps.entity.y.max;
+                app->maps.visiblity[ryce_grid_idx(vx, vy, app->maps.entity.length)] = 3;
                 return vec;
             }
         }
@@ -266,6 +350,7 @@ void move_player(AppState *app) {
     RYCE_EntityID entity_id = ryce_map_get_entity(&app->maps.entity, &dest);
     if (entity_id != RYCE_ENTITY_NONE && (app->entities[entity_id].attr & ATTR_WALKABLE)) {
         app->player.pos = dest;
+        ryce_spatial_move(&app->maps.actors, app->player.handle, &dest);
         move_accumulator -= 1.0;
         app->player.last_move = app->loop.tick;
     } else {
@@ -327,8 +412,9 @@ void input_action(AppState *app) {
 // --- Tick Actions ------------------------------------------------------ //
 void tick_action(AppState *app) {
     move_player(app);
+    update_path(app);
 
-    for (uint32_t i = 0; i < MAP_MAX_X * MAP_MAX_Y; i++) {
+    for (uint32_t i = 0; i < RYCE_GRID_LEN(MAP_MAX_X, MAP_MAX_Y); i++) {
         app->maps.visiblity[i] &= ~RYCE_FOV_VISIBLE;
     }
 
@@ -337,12 +423,50 @@ void tick_action(AppState *app) {
     ryce_fov(cx, cy, 20, app->maps.path, app->maps.visiblity, app->maps.entity.length, app->maps.entity.width);
 }
 
+// --- Resize Actions ---------------------------------------------------- //
+// Reallocates the TUI and lays out the panes after the terminal changed size.
+void resize_action(AppState *app) {
+    if (!resized) {
+        return;
+    }
+
+    resized = 0;
+    RYCE_Vec2 term_size = get_terminal_size();
+    if (term_size.x <= 0 || term_size.y <= DEBUG_HEIGHT) {
+        // Too few rows to place the debug pane.
+        return;
+    }
+
+    if (ryce_resize_tui_ctx(&app->tui, term_size.x, term_size.y) != RYCE_TUI_ERR_NONE) {
+        ryce_clear_screen(&app->tui);
+        fprintf(stderr, "Failed to resize TUI.\n\r");
+        lock = 1;
+        return;
+    }
+
+    ryce_init_camera_ctx(&app->camera, term_size.x, term_size.y, app->camera.center);
+    ryce_resize_pane(&app->panes.map, 0, 0, term_size.x, term_size.y);
+    ryce_resize_pane(&app->panes.debug, 0, term_size.y - DEBUG_HEIGHT, DEBUG_WIDTH, DEBUG_HEIGHT);
+}
+
 // --- Render Actions ---------------------------------------------------- //
 // Draws the map onto the TUI pane.
 void render_map(AppState *app) {
     int pane_width = app->panes.map.view.width;
     int pane_height = app->panes.map.view.height;
 
+    // Grow the staging buffer the map is drawn into before being copied onto the pane.
+    const size_t cells = (size_t)pane_width * pane_height;
+    if (cells > app->draw.capacity) {
+        RYCE_Glyph *glyphs = (RYCE_Glyph *)realloc(app->draw.glyphs, cells * sizeof(RYCE_Glyph));
+        if (glyphs == nullptr) {
+            return;
+        }
+
+        app->draw.glyphs = glyphs;
+        app->draw.capacity = cells;
+    }
+
     for (int ty = 0; ty < pane_height; ty++) {
         for (int tx = 0; tx < pane_width; tx++) {
             // Calculate the map coordinate, the offset from the TUI’s center is added
@@ -355,26 +479,22 @@ void render_map(AppState *app) {
             // Draw the default empty glpyh if outside the map bounds.
             if (map_x < app->maps.entity.x.min || map_x > app->maps.entity.x.max || map_y < app->maps.entity.y.min ||
                 map_y > app->maps.entity.y.max) {
-                ryce_pane_set(&app->panes.map, tx, ty, &RYCE_DEFAULT_GLYPH);
+                app->draw.glyphs[(ty * pane_width) + tx] = RYCE_DEFAULT_GLYPH;
                 continue;
             }
 
             RYCE_Glyph glyph = RYCE_DEFAULT_GLYPH;
             glyph.style.part.style_flags = RYCE_STYLE_MODIFIER_BOLD;
             RYCE_Vec3 position = {.x = map_x, .y = map_y, .z = app->player.pos.z};
-            RYCE_EntityID entity = RYCE_ENTITY_NONE;
-
-            // Search elevations below player's Z for map entities.
-            for (; position.z >= app->maps.entity.z.min; position.z--) {
-                entity = ryce_map_get_entity(&app->maps.entity, &position);
-                if (entity == RYCE_ENTITY_NONE) {
-                    continue;
-                }
+            RYCE_Vec3 top;
 
+            // Draw the highest map entity at or below the player's Z.
+            if (ryce_map_get_top_below(&app->maps.entity, &position, &top) == RYCE_MAP_ERR_NONE) {
+                RYCE_EntityID entity = ryce_map_get_entity(&app->maps.entity, &top);
                 glyph.ch = app->entities[entity].glyph->ch;
                 glyph.style.part.fg_color = app->entities[entity].glyph->style.part.fg_color;
                 glyph.style.part.bg_color = app->entities[entity].glyph->style.part.bg_color;
-                if (position.z < app->player.pos.z) {
+                if (top.z < app->player.pos.z) {
                     // Add styling to the lower elevations.
                     glyph.style.part.style_flags = RYCE_STYLE_MODIFIER_DIM | RYCE_STYLE_MODIFIER_ITALIC;
                 }
@@ -382,7 +502,7 @@ void render_map(AppState *app) {
                 // Visibility check.
                 uint32_t vx = map_x + app->maps.entity.x.max;
                 uint32_t vy = map_y + app->maps.entity.y.max;
-                uint32_t idx = vx + (vy * app->maps.entity.length);
+                size_t idx = ryce_grid_idx(vx, vy, app->maps.entity.length);
                 uint8_t flags = app->maps.visiblity[idx];
                 if (flags == RYCE_FOV_UNSEEN) {
                     // If the cell is unseen, set the glyph to the default.
@@ -395,9 +515,34 @@ void render_map(AppState *app) {
                 }
             }
 
-            ryce_pane_set(&app->panes.map, tx, ty, &glyph);
+            app->draw.glyphs[(ty * pane_width) + tx] = glyph;
         }
     }
+
+    // Draw the actors on the player's level over the terrain.
+    RYCE_Vec2 corner = ryce_get_center_offset(&app->camera, &(RYCE_Vec2){0, 0});
+    RYCE_Vec3 min = {.x = corner.x, .y = corner.y, .z = app->player.pos.z};
+    RYCE_Vec3 max = {.x = corner.x + pane_width - 1, .y = corner.y + pane_height - 1, .z = app->player.pos.z};
+    size_t found = ryce_spatial_query_rect(&app->maps.actors, &min, &max, app->draw.actors, app->draw.actor_capacity);
+    if (found > app->draw.actor_capacity) {
+        RYCE_SpatialHandle *actors =
+            (RYCE_SpatialHandle *)realloc(app->draw.actors, found * sizeof(RYCE_SpatialHandle));
+        if (actors == nullptr) {
+            return;
+        }
+
+        app->draw.actors = actors;
+        app->draw.actor_capacity = found;
+        found = ryce_spatial_query_rect(&app->maps.actors, &min, &max, app->draw.actors, app->draw.actor_capacity);
+    }
+
+    for (size_t i = 0; i < found; i++) {
+        const RYCE_SpatialNode *actor = &app->maps.actors.nodes[app->draw.actors[i]];
+        const size_t idx = ((size_t)(actor->pos.y - corner.y) * pane_width) + (size_t)(actor->pos.x - corner.x);
+        app->draw.glyphs[idx] = *app->entities[actor->entity].glyph;
+    }
+
+    ryce_pane_blit(&app->panes.map, 0, 0, pane_width, pane_height, app->draw.glyphs, pane_width);
 }
 
 void render_debug(AppState *app) {
@@ -420,20 +565,37 @@ void render_debug(AppState *app) {
     RYCE_SNPRINTF(buffer, sizeof(buffer), RYCE_LITERAL("Position: %lld, %lld, %lld  "), app->player.pos.x,
                   app->player.pos.y, app->player.pos.z);
     ryce_pane_set_str(&app->panes.debug, 0, 3, &RYCE_DEFAULT_STYLE, buffer);
+
+    // Cost of the last rendered frame.
+    RYCE_TuiStats stats;
+    ryce_tui_get_stats(&app->tui, &stats);
+    RYCE_SNPRINTF(buffer, sizeof(buffer), RYCE_LITERAL("Frame: %llu B, %llu cells  "),
+                  (unsigned long long)stats.bytes, (unsigned long long)stats.cells);
+    ryce_pane_set_str(&app->panes.debug, 0, 4, &RYCE_DEFAULT_STYLE, buffer);
+
+    RYCE_SNPRINTF(buffer, sizeof(buffer), RYCE_LITERAL("SGR: %llu Move: %llu Rep: %llu  "),
+                  (unsigned long long)stats.styles, (unsigned long long)stats.moves,
+                  (unsigned long long)stats.reprints);
+    ryce_pane_set_str(&app->panes.debug, 0, 5, &RYCE_DEFAULT_STYLE, buffer);
+
+    RYCE_SNPRINTF(buffer, sizeof(buffer), RYCE_LITERAL("Diff: %lluus Flush: %lluus  "),
+                  (unsigned long long)(stats.diff_ns / 1000), (unsigned long long)(stats.flush_ns / 1000));
+    ryce_pane_set_str(&app->panes.debug, 0, 6, &RYCE_DEFAULT_STYLE, buffer);
 }
 
 void render_action(AppState *app) {
     // Set the camera to be centered on the player in the event the player moved.
+    const RYCE_Vec2 previous = app->camera.center;
     app->camera.center = (RYCE_Vec2){.x = app->player.pos.x, .y = app->player.pos.y};
 
+    // Scroll the map opposite to the camera so only the newly exposed edge is redrawn.
+    ryce_pane_scroll(&app->panes.map, (int32_t)(previous.x - app->camera.center.x),
+                     (int32_t)(previous.y - app->camera.center.y));
+
     // For each cell in the TUI, determine which map coordinate to show.
     bool is_moving = app->loop.tick - app->player.last_move < TICKS_PER_SECOND / DIST_PER_SECOND;
     render_map(app);
 
-    // Draw the player at the center of the TUI.
-    RYCE_Vec2 player = ryce_get_screen_offset(&app->camera, &(RYCE_Vec2){app->player.pos.x, app->player.pos.y});
-    ryce_pane_set(&app->panes.map, player.x, player.y, &GLYPHS[6]);
-
     if (is_moving) {
         // Draw the player’s destination.
         RYCE_Vec2 dest_term =
@@ -447,7 +609,9 @@ void render_action(AppState *app) {
     // Render the TUI.
     RYCE_TuiError err_code = ryce_render_tui(&app->tui);
     if (err_code != RYCE_TUI_ERR_NONE) {
-        ryce_clear_screen();
+        // Take the output back from the render thread before clearing.
+        ryce_tui_stop_render_thread(&app->tui);
+        ryce_clear_screen(&app->tui);
         fprintf(stderr, "Failed to render TUI: %d\n\r", err_code);
         lock = 1;
     }
@@ -465,6 +629,13 @@ int main(void) {
         exit(EXIT_FAILURE);
     }
 
+    // Register SIGWINCH handler.
+    sa.sa_handler = handle_sigwinch;
+    if (sigaction(SIGWINCH, &sa, NULL) == -1) {
+        perror("sigaction");
+        exit(EXIT_FAILURE);
+    }
+
     AppState app = {0};
 
     // Initialize the camera.
@@ -488,11 +659,18 @@ int main(void) {
     }
 
     // Initialize the debug pane.
-    if (ryce_init_pane(0, term_size.y - 4, 30, 4, &app.tui, &app.panes.debug) != RYCE_TUI_ERR_NONE) {
+    if (term_size.y <= DEBUG_HEIGHT) {
+        fprintf(stderr, "Terminal needs more than %u rows.\n", DEBUG_HEIGHT);
+        return EXIT_FAILURE;
+    } else if (ryce_init_pane(0, term_size.y - DEBUG_HEIGHT, DEBUG_WIDTH, DEBUG_HEIGHT, &app.tui, &app.panes.debug) !=
+        RYCE_TUI_ERR_NONE) {
         fprintf(stderr, "Failed to init debug pane.\n");
         return EXIT_FAILURE;
     }
 
+    // Keep the debug overlay above the map.
+    ryce_pane_set_z(&app.panes.debug, 1);
+
     // Initialize the loop context.
     if (ryce_init_loop_ctx(&lock, TICKS_PER_SECOND, &app.loop) != RYCE_LOOP_ERR_NONE) {
         fprintf(stderr, "Failed to init loop context.\n");
@@ -514,20 +692,44 @@ int main(void) {
         return EXIT_FAILURE;
     }
 
+    // Initialize the dynamic actors layer.
+    if (ryce_init_spatial_hash(&app.maps.actors, 64) != RYCE_SPATIAL_ERR_NONE) {
+        fprintf(stderr, "Failed to init actors.\n");
+        return EXIT_FAILURE;
+    }
+
     // Initialize entities and player.
     init_entities(&app);
     init_map(&app);
     app.player.pos = init_player(&app);
+    if (ryce_spatial_insert(&app.maps.actors, 6, &app.player.pos, &app.player.handle) != RYCE_SPATIAL_ERR_NONE) {
+        fprintf(stderr, "Failed to place player.\n");
+        return EXIT_FAILURE;
+    }
+
+    ryce_clear_screen(&app.tui);
+
+    // Draw frames on their own thread so terminal output never stalls the ticks.
+    if (ryce_tui_start_render_thread(&app.tui, FRAMES_PER_SECOND) != RYCE_TUI_ERR_NONE) {
+        fprintf(stderr, "Failed to start render thread.\n");
+        return EXIT_FAILURE;
+    }
 
-    ryce_clear_screen();
     do {
+        resize_action(&app);
         input_action(&app);
         tick_action(&app);
         render_action(&app);
     } while (ryce_loop_tick(&app.loop) == RYCE_LOOP_ERR_NONE);
 
+    ryce_tui_stop_render_thread(&app.tui);
     ryce_input_join(&app.input);
     ryce_input_free_ctx(&app.input);
+    ryce_tui_free_ctx(&app.tui);
+    ryce_map_free(&app.maps.entity);
+    ryce_spatial_free(&app.maps.actors);
+    free(app.draw.glyphs);
+    free(app.draw.actors);
     return 0;
 }
 // NOLINTEND
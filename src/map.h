@@ -19,6 +19,7 @@
 */
 #define RYCE_MAP_H
 
+#include "grid.h" // ryce_morton_encode2
 #include <stddef.h>
 #include <stdint.h>
 
@@ -53,6 +54,11 @@ typedef enum RYCE_MapError {
     RYCE_MAP_INVALID_DATA,       ///< Invalid map data.
     RYCE_MAP_INVALID_PLACEMENT,  ///< Invalid entity placement.
     RYCE_MAP_ENTITY_NOT_FOUND,   ///< Entity not found.
+    RYCE_MAP_PALETTE_FULL,       ///< No tile index left for a new entity.
+    RYCE_MAP_SOURCE_FAILED,      ///< A chunk could not be generated, loaded or saved.
+    RYCE_MAP_IO_FAILED,          ///< Reading or writing a map file failed.
+    RYCE_MAP_BAD_FORMAT,         ///< Map file has the wrong magic, version or layout.
+    RYCE_MAP_JOURNAL_OVERRUN,    ///< Changes were dropped from the journal before they were read.
 } RYCE_MapError;
 
 /*
@@ -74,23 +80,114 @@ typedef struct RYCE_Vec3 {
 } RYCE_Vec3;
 #endif // RYCE_VEC3
 
+#ifndef RYCE_MAP_CHUNK_SIZE
+#define RYCE_MAP_CHUNK_SIZE 32 // Cells along each horizontal side of a chunk, chunks are one level deep.
+#endif // RYCE_MAP_CHUNK_SIZE
+
+// Cells inside a chunk are row-major, define RYCE_MAP_MORTON_CELLS to store them in Z-order (see grid.h) so square
+// neighborhoods share cache lines. The chunk size must then be a power of two.
+#ifdef RYCE_MAP_MORTON_CELLS
+_Static_assert((RYCE_MAP_CHUNK_SIZE & (RYCE_MAP_CHUNK_SIZE - 1)) == 0, "Z-order cells need a power of two chunk.");
+#define RYCE_MAP_CELL_ORDER 1
+#else
+#define RYCE_MAP_CELL_ORDER 0
+#endif // RYCE_MAP_MORTON_CELLS
+
+// Cells store indices into the map's palette, define RYCE_MAP_WIDE_TILES for more than 255 distinct entities.
+#ifdef RYCE_MAP_WIDE_TILES
+typedef uint16_t RYCE_MapTile;
+#define RYCE_MAP_TILE_MAX UINT16_MAX
+#else
+typedef uint8_t RYCE_MapTile;
+#define RYCE_MAP_TILE_MAX UINT8_MAX
+#endif // RYCE_MAP_WIDE_TILES
+
+typedef struct RYCE_MapChunk {
+    size_t count;                                                   //< Occupied cells in the chunk.
+    RYCE_MapTile cells[RYCE_MAP_CHUNK_SIZE * RYCE_MAP_CHUNK_SIZE]; //< Palette indices, see RYCE_MAP_MORTON_CELLS.
+} RYCE_MapChunk;
+
+typedef struct RYCE_MapPalette {
+    size_t count;        //< Entities in the palette, index 0 is always RYCE_ENTITY_NONE.
+    size_t capacity;     //< Allocated length of ids.
+    RYCE_EntityID *ids;  //< Entity of each tile index.
+    size_t slots_len;    //< Allocated length of slots, a power of two.
+    RYCE_MapTile *slots; //< Open-addressed lookup from entity to tile index, 0 marks a free slot.
+} RYCE_MapPalette;
+
+#ifndef RYCE_MAP_JOURNAL_SIZE
+#define RYCE_MAP_JOURNAL_SIZE 1024 // Changes kept for readers, a power of two.
+#endif // RYCE_MAP_JOURNAL_SIZE
+_Static_assert((RYCE_MAP_JOURNAL_SIZE & (RYCE_MAP_JOURNAL_SIZE - 1)) == 0, "The journal size must be a power of two.");
+
+typedef struct RYCE_MapChange {
+    RYCE_Vec3 pos;         //< Cell that changed.
+    RYCE_EntityID before;  //< Entity before the change.
+    RYCE_EntityID after;   //< Entity after the change.
+} RYCE_MapChange;
+
+typedef struct RYCE_MapJournal {
+    uint64_t head;                                  //< Changes recorded so far, the sequence of the next change.
+    RYCE_MapChange changes[RYCE_MAP_JOURNAL_SIZE]; //< Ring of the latest changes, indexed by sequence.
+} RYCE_MapJournal;
+
 typedef struct RYCE_3dTextMap {
     struct {
         int64_t min; //< Minimum value on axis.
         int64_t max; //< Maximum value on axis.
     } x, y, z;
-    size_t length;       //< Length of the 3D space.
-    size_t width;        //< Width of the 3D space.
-    size_t height;       //< Height of the 3D space.
-    RYCE_EntityID *data; //< 3D map data.
+    size_t length;            //< Length of the 3D space.
+    size_t width;             //< Width of the 3D space.
+    size_t height;            //< Height of the 3D space.
+    size_t chunks_x;          //< Chunks along the length.
+    size_t chunks_y;          //< Chunks along the width.
+    RYCE_MapChunk **chunks;   //< Chunk table [chunks_x * chunks_y * height], empty chunks share one sentinel.
+    RYCE_MapPalette *palette; //< Entities referenced by the cells, unused entries are reclaimed when it fills.
+    uint32_t *tops;           //< Highest occupied level + 1 of each (x, y) column [length * width], 0 when empty.
+    uint64_t *versions;       //< Edits to each chunk [chunks_x * chunks_y * height], bumped on every change.
+    RYCE_MapJournal *journal; //< Latest changes for readers that update derived data incrementally.
+    void *file;               //< Private mapping of the file the map was loaded from, nullptr if built in memory.
+    size_t file_size;         //< Length of the mapping.
+    int file_fd;              //< Descriptor of the mapped file, clean chunks are copied from it on save.
 } RYCE_3dTextMap;
 
+/*
+    Map File Format
+
+    Native byte order, every section starts 8 byte aligned. Chunks and tops are used in place from the mapping, so
+    the tile width and cell order must match the build loading them.
+
+        RYCE_MapFileHeader
+        uint64_t palette[palette_count]           Entity of each tile index.
+        uint64_t index[chunks_x * chunks_y * height] File offset of each chunk, 0 for empty chunks.
+        uint32_t tops[length * width]             Same as RYCE_3dTextMap.tops.
+        RYCE_MapChunk chunks[chunk_count]
+*/
+#define RYCE_MAP_FILE_MAGIC "RYCEMAP"
+#define RYCE_MAP_FILE_VERSION 2
+
+typedef struct RYCE_MapFileHeader {
+    char magic[8];          //< RYCE_MAP_FILE_MAGIC.
+    uint32_t version;       //< RYCE_MAP_FILE_VERSION.
+    uint32_t byte_order;    //< 0x01020304 as written by the saving host.
+    uint32_t tile_size;     //< sizeof(RYCE_MapTile).
+    uint32_t chunk_size;    //< RYCE_MAP_CHUNK_SIZE.
+    uint32_t cell_order;    //< RYCE_MAP_CELL_ORDER.
+    uint32_t reserved;      //< Zero.
+    uint64_t length;        //< Length of the 3D space.
+    uint64_t width;         //< Width of the 3D space.
+    uint64_t height;        //< Height of the 3D space.
+    uint64_t palette_count; //< Entries in the palette, including RYCE_ENTITY_NONE.
+    uint64_t chunk_count;   //< Non-empty chunks stored.
+} RYCE_MapFileHeader;
+
 /*
     Public API Functions
 */
 
 /**
- * @brief Initializes a 3D map.
+ * @brief Initializes a 3D map. Only the chunk table is allocated, chunks are allocated on their first entity and
+ * released when their last entity is removed. Release the map with `ryce_map_free`.
  *
  * @param map Map to initialize.
  * @param length Length of the 3D space.
@@ -101,7 +198,39 @@ typedef struct RYCE_3dTextMap {
 RYCE_PUBLIC_DECL RYCE_MapError ryce_init_3d_map(RYCE_3dTextMap *map, size_t length, size_t width, size_t height);
 
 /**
- * @brief Maps an entity to a 3D coordinate.
+ * @brief Loads a map written by `ryce_map_save`. The file is mapped privately, chunks are read from it as they are
+ * first touched and edits stay in memory. Only the header, the section bounds and the chunk index are checked up
+ * front. A column top above the map is rescanned when its column is first read, and a tile index outside the file's
+ * palette reads as `RYCE_ENTITY_NONE`.
+ *
+ * @param map Map to initialize.
+ * @param path File to load.
+ * @return RYCE_MapError RYCE_MAP_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_MapError ryce_map_load(RYCE_3dTextMap *map, const char *path);
+
+/**
+ * @brief Saves a map. The file is written next to `path` and renamed over it once complete, so a failed save
+ * leaves the previous file intact. A map loaded from `path` keeps reading its original mapping. Chunks not edited
+ * since the load are copied from the loaded file by the kernel, only the edited ones are written from memory.
+ *
+ * @param map Map to save.
+ * @param path File to write.
+ * @return RYCE_MapError RYCE_MAP_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_MapError ryce_map_save(const RYCE_3dTextMap *map, const char *path);
+
+/**
+ * @brief Frees the chunks, the chunk table and the palette of a 3D map.
+ *
+ * @param map Map to free.
+ */
+RYCE_PUBLIC_DECL void ryce_map_free(RYCE_3dTextMap *map);
+
+/**
+ * @brief Maps an entity to a 3D coordinate. An entity not seen before takes the next free palette index. A full palette
+ * is compacted first, dropping entities no longer on the map and renumbering the cells of every chunk, and only fails
+ * with RYCE_MAP_PALETTE_FULL once RYCE_MAP_TILE_MAX distinct entities are in use.
  *
  * @param map Map to place the entity.
  * @param vec 3D coordinates to place the entity.
@@ -131,6 +260,201 @@ RYCE_PUBLIC_DECL RYCE_MapError ryce_map_remove_entity(const RYCE_3dTextMap *map,
  */
 RYCE_PUBLIC_DECL RYCE_EntityID ryce_map_get_entity(const RYCE_3dTextMap *map, const RYCE_Vec3 *vec);
 
+/**
+ * @brief Gets the version of the chunk holding a 3D coordinate. Versions only grow, a derived structure that
+ * recorded the version it was built from can compare it to tell whether the chunk changed since. Coordinates are
+ * clamped like `ryce_map_get_entity`.
+ *
+ * @param map Map to query.
+ * @param vec 3D coordinates inside the chunk.
+ * @return uint64_t Version of the chunk, 0 if it was never edited.
+ */
+RYCE_PUBLIC_DECL uint64_t ryce_map_chunk_version(const RYCE_3dTextMap *map, const RYCE_Vec3 *vec);
+
+/**
+ * @brief Gets the sequence the next change will have. Readers start their cursor here.
+ *
+ * @param map Map to query.
+ * @return uint64_t Sequence of the next change.
+ */
+RYCE_PUBLIC_DECL uint64_t ryce_map_journal_head(const RYCE_3dTextMap *map);
+
+/**
+ * @brief Copies the changes made since `cursor` and advances it past them. The journal keeps the latest
+ * RYCE_MAP_JOURNAL_SIZE changes, a reader that fell further behind gets RYCE_MAP_JOURNAL_OVERRUN, its cursor is moved
+ * to the head and it has to rebuild its derived data from the map.
+ *
+ * @param map Map to read from.
+ * @param cursor Sequence of the first change to read, updated to the first change not read.
+ * @param out Filled with up to `max_out` changes, oldest first.
+ * @param max_out Length of `out`.
+ * @param count Set to the number of changes copied.
+ * @return RYCE_MapError RYCE_MAP_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_MapError ryce_map_read_changes(const RYCE_3dTextMap *map, uint64_t *cursor,
+                                                     RYCE_MapChange *out, size_t max_out, size_t *count);
+
+/**
+ * @brief Gets the highest occupied cell of the column at (x, y). Coordinates are clamped like
+ * `ryce_map_get_entity`, `vec->z` is ignored.
+ *
+ * @param map Map to search.
+ * @param vec 3D coordinates of the column.
+ * @param top Set to the coordinates of the highest occupied cell.
+ * @return RYCE_MapError RYCE_MAP_ERR_NONE if found, RYCE_MAP_ENTITY_NOT_FOUND if the column is empty.
+ */
+RYCE_PUBLIC_DECL RYCE_MapError ryce_map_get_top(const RYCE_3dTextMap *map, const RYCE_Vec3 *vec, RYCE_Vec3 *top);
+
+/**
+ * @brief Gets the highest occupied cell of the column at (x, y) at or below `vec->z`. Costs one lookup when nothing
+ * in the column is above `vec->z`, otherwise the column is scanned down from `vec->z`.
+ *
+ * @param map Map to search.
+ * @param vec 3D coordinates to search down from.
+ * @param top Set to the coordinates of the highest occupied cell at or below `vec`.
+ * @return RYCE_MapError RYCE_MAP_ERR_NONE if found, RYCE_MAP_ENTITY_NOT_FOUND if there is none.
+ */
+RYCE_PUBLIC_DECL RYCE_MapError ryce_map_get_top_below(const RYCE_3dTextMap *map, const RYCE_Vec3 *vec,
+                                                      RYCE_Vec3 *top);
+
+/**
+ * @brief Copies the entities of consecutive cells along the X axis. Bounds are resolved once and each chunk's span
+ * is copied in one pass. Unlike `ryce_map_get_entity`, cells outside the map are not clamped, they read as
+ * RYCE_ENTITY_NONE.
+ *
+ * @param map Map to read from.
+ * @param start 3D coordinates of the first cell.
+ * @param count Number of cells to copy.
+ * @param out Pointer to at least `count` entities to fill.
+ * @return RYCE_MapError RYCE_MAP_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_MapError ryce_map_get_row(const RYCE_3dTextMap *map, const RYCE_Vec3 *start, size_t count,
+                                                RYCE_EntityID *out);
+
+/**
+ * @brief Copies the entities of a box, both corners inclusive, row by row. The row at (y, z) starts at
+ * `out + (((z - min->z) * rows) + (y - min->y)) * stride`, where `rows` is `max->y - min->y + 1`. Cells outside
+ * the map read as RYCE_ENTITY_NONE.
+ *
+ * @param map Map to read from.
+ * @param min 3D coordinates of the lowest corner.
+ * @param max 3D coordinates of the highest corner.
+ * @param out Pointer to the entities to fill.
+ * @param stride Entities between the starts of two rows in `out`, at least `max->x - min->x + 1`.
+ * @return RYCE_MapError RYCE_MAP_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_MapError ryce_map_get_region(const RYCE_3dTextMap *map, const RYCE_Vec3 *min,
+                                                   const RYCE_Vec3 *max, RYCE_EntityID *out, size_t stride);
+
+/*
+    Streaming Map
+
+    An unbounded map, chunks are keyed by chunk coordinates and brought in on first use, loaded from the source's
+    store when it has them and generated otherwise. Resident chunks are kept under a memory budget, the least
+    recently used ones are evicted to make room and saved first when they were edited. A chunk is charged for its
+    cells and its palette allocation, so chunks holding many distinct entities cost more. Every chunk has its own
+    palette, rebuilt whenever the chunk is brought in, so RYCE_MAP_TILE_MAX limits the distinct entities of one chunk
+    and not of everything streamed so far.
+*/
+
+/**
+ * @brief Where the chunks of a streaming map come from. Chunks are passed as RYCE_MAP_CHUNK_SIZE rows of
+ * RYCE_MAP_CHUNK_SIZE entities, `origin` is the coordinate of the first one. Callbacks return RYCE_MAP_ERR_NONE on
+ * success.
+ */
+typedef struct RYCE_MapSource {
+    void *user; //< Passed back to every callback.
+
+    // Fills a chunk that was never stored, required.
+    RYCE_MapError (*generate)(void *user, const RYCE_Vec3 *origin, RYCE_EntityID *cells);
+
+    // Fills a stored chunk or returns RYCE_MAP_ENTITY_NOT_FOUND, optional.
+    RYCE_MapError (*load)(void *user, const RYCE_Vec3 *origin, RYCE_EntityID *cells);
+
+    // Stores an edited chunk, optional, edits are dropped on eviction without it.
+    RYCE_MapError (*save)(void *user, const RYCE_Vec3 *origin, const RYCE_EntityID *cells);
+} RYCE_MapSource;
+
+typedef struct RYCE_StreamChunk {
+    RYCE_Vec3 key;                  //< Chunk coordinates, the first cell is at key * RYCE_MAP_CHUNK_SIZE on X and Y.
+    bool dirty;                     //< Edited since it was brought in.
+    struct RYCE_StreamChunk *newer; //< Next more recently used chunk.
+    struct RYCE_StreamChunk *older; //< Next less recently used chunk.
+    RYCE_MapPalette *palette;       //< Entities referenced by the cells.
+    size_t charge;                  //< Bytes counted against the budget, the chunk and its palette.
+    RYCE_MapChunk chunk;            //< Cells of the chunk.
+} RYCE_StreamChunk;
+
+typedef struct RYCE_StreamMap {
+    RYCE_MapSource source;      //< Chunk generator and store.
+    size_t resident;            //< Chunks in memory.
+    size_t used;                //< Bytes charged to the resident chunks.
+    size_t budget;              //< Most bytes kept in memory, the newest chunk stays even when it alone is over.
+    size_t slots_len;           //< Length of slots, a power of two at least twice the chunks the budget can hold.
+    RYCE_StreamChunk **slots;   //< Open-addressed lookup from chunk coordinates to chunk, nullptr marks a free slot.
+    RYCE_StreamChunk *newest;   //< Most recently used chunk.
+    RYCE_StreamChunk *oldest;   //< Least recently used chunk, evicted first.
+    RYCE_EntityID *scratch;     //< One chunk of entities handed to the source.
+} RYCE_StreamMap;
+
+/**
+ * @brief Initializes a streaming map. Nothing is generated until a chunk is first used. Release the map with
+ * `ryce_stream_map_free`.
+ *
+ * @param map Map to initialize.
+ * @param source Chunk generator and optional store, copied into the map.
+ * @param budget Bytes of chunks and their palettes to keep in memory, at least one chunk is always kept.
+ * @return RYCE_MapError RYCE_MAP_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_MapError ryce_init_stream_map(RYCE_StreamMap *map, const RYCE_MapSource *source,
+                                                    size_t budget);
+
+/**
+ * @brief Saves every edited chunk still in memory.
+ *
+ * @param map Map to flush.
+ * @return RYCE_MapError RYCE_MAP_ERR_NONE if successful, otherwise the first error returned by the source.
+ */
+RYCE_PUBLIC_DECL RYCE_MapError ryce_stream_map_flush(RYCE_StreamMap *map);
+
+/**
+ * @brief Frees the chunks of a streaming map. Edited chunks are not saved, flush the map first.
+ *
+ * @param map Map to free.
+ */
+RYCE_PUBLIC_DECL void ryce_stream_map_free(RYCE_StreamMap *map);
+
+/**
+ * @brief Maps an entity to a 3D coordinate, bringing its chunk in if needed.
+ *
+ * @param map Map to place the entity.
+ * @param vec 3D coordinates to place the entity.
+ * @param entity Entity to place.
+ * @return RYCE_MapError RYCE_MAP_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_MapError ryce_stream_map_add_entity(RYCE_StreamMap *map, const RYCE_Vec3 *vec,
+                                                          RYCE_EntityID entity);
+
+/**
+ * @brief Unmaps an entity from a 3D coordinate, bringing its chunk in if needed.
+ *
+ * @param map Map to remove the entity from.
+ * @param vec 3D coordinates to remove the entity from.
+ * @param entity Entity to remove.
+ * @return RYCE_MapError RYCE_MAP_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_MapError ryce_stream_map_remove_entity(RYCE_StreamMap *map, const RYCE_Vec3 *vec,
+                                                             RYCE_EntityID entity);
+
+/**
+ * @brief Gets the entity at a 3D coordinate, bringing its chunk in if needed.
+ *
+ * @param map Map to get the entity from.
+ * @param vec 3D coordinates to get the entity from.
+ * @return RYCE_EntityID Entity at the 3D coordinates, RYCE_ENTITY_NONE if the chunk could not be brought in.
+ */
+RYCE_PUBLIC_DECL RYCE_EntityID ryce_stream_map_get_entity(RYCE_StreamMap *map, const RYCE_Vec3 *vec);
+
 /*===========================================================================
    ▗▄▄▄▖▗▖  ▗▖▗▄▄▖ ▗▖   ▗▄▄▄▖▗▖  ▗▖▗▄▄▄▖▗▖  ▗▖▗▄▄▄▖ ▗▄▖ ▗▄▄▄▖▗▄▄▄▖ ▗▄▖ ▗▖  ▗▖
      █  ▐▛▚▞▜▌▐▌ ▐▌▐▌   ▐▌   ▐▛▚▞▜▌▐▌   ▐▛▚▖▐▌  █  ▐▌ ▐▌  █    █  ▐▌ ▐▌▐▛▚▖▐▌
@@ -141,7 +465,14 @@ RYCE_PUBLIC_DECL RYCE_EntityID ryce_map_get_entity(const RYCE_3dTextMap *map, co
   ===========================================================================*/
 #ifdef RYCE_MAP_IMPL
 
+#include <fcntl.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #ifndef RYCE_MATH_CLAMP
 #define RYCE_MATH_CLAMP
@@ -150,7 +481,26 @@ RYCE_PUBLIC inline int64_t ryce_math_clamp(int64_t val, int64_t min, int64_t max
 }
 #endif // RYCE_MATH_CLAMP
 
-RYCE_PRIVATE inline size_t ryce_translate_vec_internal(const RYCE_3dTextMap *map, const RYCE_Vec3 *vec) {
+// Shared by every chunk without entities, never written to.
+static const RYCE_MapChunk RYCE_MAP_EMPTY_CHUNK = {0};
+
+typedef struct RYCE_MapCell {
+    size_t chunk;  // Index in the chunk table.
+    size_t cell;   // Index in the chunk.
+    size_t column; // Index in the column table.
+    size_t level;  // 0-based level.
+} RYCE_MapCell;
+
+RYCE_PRIVATE inline size_t ryce_map_cell_internal(const size_t col, const size_t row) {
+    // Index of a cell in its chunk.
+#ifdef RYCE_MAP_MORTON_CELLS
+    return (size_t)ryce_morton_encode2((uint32_t)col, (uint32_t)row);
+#else
+    return (row * RYCE_MAP_CHUNK_SIZE) + col;
+#endif // RYCE_MAP_MORTON_CELLS
+}
+
+RYCE_PRIVATE inline RYCE_MapCell ryce_translate_vec_internal(const RYCE_3dTextMap *map, const RYCE_Vec3 *vec) {
     // Determine the offset needed to shift user coordinates into 0-based indices.
     // Since map->x.min == -(length/2), we have:
     const int64_t x_offset = -(map->x.min); // equivalent to map->length/2
@@ -158,12 +508,195 @@ RYCE_PRIVATE inline size_t ryce_translate_vec_internal(const RYCE_3dTextMap *map
     const int64_t z_offset = -(map->z.min); // equivalent to map->height/2
 
     // Translate user coordinates to internal indices.
-    const int64_t internal_x = ryce_math_clamp(vec->x + x_offset, 0, (int64_t)map->length - 1);
-    const int64_t internal_y = ryce_math_clamp(vec->y + y_offset, 0, (int64_t)map->width - 1);
-    const int64_t internal_z = ryce_math_clamp(vec->z + z_offset, 0, (int64_t)map->height - 1);
+    const size_t internal_x = (size_t)ryce_math_clamp(vec->x + x_offset, 0, (int64_t)map->length - 1);
+    const size_t internal_y = (size_t)ryce_math_clamp(vec->y + y_offset, 0, (int64_t)map->width - 1);
+    const size_t internal_z = (size_t)ryce_math_clamp(vec->z + z_offset, 0, (int64_t)map->height - 1);
 
-    // Convert 3D indices to a 1D index.
-    return (internal_z * map->length * map->width) + (internal_y * map->length) + internal_x;
+    // Split the indices into the chunk and the cell within it.
+    const size_t chunk_x = internal_x / RYCE_MAP_CHUNK_SIZE;
+    const size_t chunk_y = internal_y / RYCE_MAP_CHUNK_SIZE;
+    return (RYCE_MapCell){
+        .chunk = (internal_z * map->chunks_x * map->chunks_y) + (chunk_y * map->chunks_x) + chunk_x,
+        .cell = ryce_map_cell_internal(internal_x % RYCE_MAP_CHUNK_SIZE, internal_y % RYCE_MAP_CHUNK_SIZE),
+        .column = (internal_y * map->length) + internal_x,
+        .level = internal_z,
+    };
+}
+
+RYCE_PRIVATE inline bool ryce_chunk_empty_internal(const RYCE_MapChunk *chunk) {
+    return chunk == &RYCE_MAP_EMPTY_CHUNK;
+}
+
+RYCE_PRIVATE inline bool ryce_chunk_owned_internal(const RYCE_3dTextMap *map, const RYCE_MapChunk *chunk) {
+    // Chunks inside the file mapping belong to it, not to the allocator.
+    const char *at = (const char *)chunk;
+    const char *file = (const char *)map->file;
+    return !ryce_chunk_empty_internal(chunk) && (file == nullptr || at < file || at >= file + map->file_size);
+}
+
+RYCE_PRIVATE void ryce_map_record_internal(const RYCE_3dTextMap *map, const RYCE_MapCell *at,
+                                          const RYCE_EntityID before, const RYCE_EntityID after) {
+    map->versions[at->chunk]++;
+    map->journal->changes[map->journal->head & (RYCE_MAP_JOURNAL_SIZE - 1)] = (RYCE_MapChange){
+        .pos =
+            {
+                .x = (int64_t)(at->column % map->length) + map->x.min,
+                .y = (int64_t)(at->column / map->length) + map->y.min,
+                .z = (int64_t)at->level + map->z.min,
+            },
+        .before = before,
+        .after = after,
+    };
+    map->journal->head++;
+}
+
+RYCE_PRIVATE uint32_t ryce_column_scan_internal(const RYCE_3dTextMap *map, const RYCE_MapCell *at, size_t level) {
+    // Walk down the column from `level`, returns the first occupied level + 1 or 0 past the bottom.
+    const size_t plane = map->chunks_x * map->chunks_y;
+    const size_t base = at->chunk - (at->level * plane);
+    for (size_t z = level + 1; z-- > 0;) {
+        if (map->chunks[base + (z * plane)]->cells[at->cell] != 0) {
+            return (uint32_t)(z + 1);
+        }
+    }
+
+    return 0;
+}
+
+RYCE_PRIVATE inline uint32_t ryce_map_top_internal(const RYCE_3dTextMap *map, const RYCE_MapCell *at) {
+    // Tops from a loaded file are checked as their column is read, rescan one pointing above the map.
+    if (map->tops[at->column] > map->height) {
+        map->tops[at->column] = ryce_column_scan_internal(map, at, map->height - 1);
+    }
+
+    return map->tops[at->column];
+}
+
+RYCE_PRIVATE void ryce_palette_free_internal(RYCE_MapPalette *palette) {
+    if (palette != nullptr) {
+        free(palette->ids);
+        free(palette->slots);
+        free(palette);
+    }
+}
+
+RYCE_PRIVATE RYCE_MapPalette *ryce_palette_new_internal(void) {
+    // Tile 0 is the empty cell.
+    RYCE_MapPalette *palette = (RYCE_MapPalette *)calloc(1, sizeof(RYCE_MapPalette));
+    if (!palette) {
+        return nullptr;
+    }
+
+    palette->count = 1;
+    palette->capacity = 8;
+    palette->ids = (RYCE_EntityID *)calloc(palette->capacity, sizeof(RYCE_EntityID));
+    palette->slots_len = 16;
+    palette->slots = (RYCE_MapTile *)calloc(palette->slots_len, sizeof(RYCE_MapTile));
+    if (!palette->ids || !palette->slots) {
+        ryce_palette_free_internal(palette);
+        return nullptr;
+    }
+
+    return palette;
+}
+
+RYCE_PRIVATE void ryce_palette_clear_internal(RYCE_MapPalette *palette) {
+    // Back to only the empty cell, keeping the allocations.
+    palette->count = 1;
+    memset(palette->slots, 0, palette->slots_len * sizeof(RYCE_MapTile));
+}
+
+RYCE_PRIVATE inline size_t ryce_palette_slot_internal(const RYCE_MapPalette *palette, const RYCE_EntityID entity) {
+    // Fibonacci hashing, then probe linearly to the entity's slot or the first free one.
+    size_t slot = (size_t)(((uint64_t)entity * 0x9E3779B97F4A7C15ULL) >> 32) & (palette->slots_len - 1);
+    while (palette->slots[slot] != 0 && palette->ids[palette->slots[slot]] != entity) {
+        slot = (slot + 1) & (palette->slots_len - 1);
+    }
+
+    return slot;
+}
+
+RYCE_PRIVATE RYCE_MapError ryce_palette_intern_internal(RYCE_MapPalette *palette, const RYCE_EntityID entity,
+                                                        RYCE_MapTile *out) {
+    size_t slot = ryce_palette_slot_internal(palette, entity);
+    if (palette->slots[slot] != 0) {
+        *out = palette->slots[slot];
+        return RYCE_MAP_ERR_NONE;
+    } else if (palette->count > RYCE_MAP_TILE_MAX) {
+        return RYCE_MAP_PALETTE_FULL;
+    }
+
+    if (palette->count == palette->capacity) {
+        const size_t capacity = palette->capacity * 2;
+        RYCE_EntityID *ids = (RYCE_EntityID *)realloc(palette->ids, capacity * sizeof(RYCE_EntityID));
+        if (!ids) {
+            return RYCE_MAP_INVALID_DATA;
+        }
+
+        palette->ids = ids;
+        palette->capacity = capacity;
+    }
+
+    if (palette->count * 2 >= palette->slots_len) {
+        // Keep the lookup at most half full, rehash every entry into a table twice the size.
+        const size_t slots_len = palette->slots_len * 2;
+        RYCE_MapTile *slots = (RYCE_MapTile *)calloc(slots_len, sizeof(RYCE_MapTile));
+        if (!slots) {
+            return RYCE_MAP_INVALID_DATA;
+        }
+
+        free(palette->slots);
+        palette->slots = slots;
+        palette->slots_len = slots_len;
+        for (size_t tile = 1; tile < palette->count; tile++) {
+            palette->slots[ryce_palette_slot_internal(palette, palette->ids[tile])] = (RYCE_MapTile)tile;
+        }
+
+        slot = ryce_palette_slot_internal(palette, entity);
+    }
+
+    *out = (RYCE_MapTile)palette->count;
+    palette->ids[palette->count++] = entity;
+    palette->slots[slot] = *out;
+    return RYCE_MAP_ERR_NONE;
+}
+
+RYCE_PRIVATE void ryce_map_read_row_internal(const RYCE_3dTextMap *map, const int64_t x, const int64_t y,
+                                             const int64_t z, const size_t count, RYCE_EntityID *out) {
+    // Coordinates are 0-based here, cells off the map are empty.
+    if (y < 0 || y >= (int64_t)map->width || z < 0 || z >= (int64_t)map->height) {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = RYCE_ENTITY_NONE;
+        }
+
+        return;
+    }
+
+    // First chunk of the band of chunks holding the row, and the row inside each of them.
+    const size_t band = (((size_t)z * map->chunks_y) + ((size_t)y / RYCE_MAP_CHUNK_SIZE)) * map->chunks_x;
+    const size_t row = (size_t)y % RYCE_MAP_CHUNK_SIZE;
+
+    size_t i = 0;
+    while (i < count) {
+        const int64_t ix = x + (int64_t)i;
+        if (ix < 0 || ix >= (int64_t)map->length) {
+            out[i++] = RYCE_ENTITY_NONE;
+            continue;
+        }
+
+        // Copy up to the end of the chunk, the map or the request.
+        const size_t col = (size_t)ix % RYCE_MAP_CHUNK_SIZE;
+        size_t span = RYCE_MAP_CHUNK_SIZE - col;
+        span = span < map->length - (size_t)ix ? span : map->length - (size_t)ix;
+        span = span < count - i ? span : count - i;
+
+        const RYCE_MapTile *cells = map->chunks[band + ((size_t)ix / RYCE_MAP_CHUNK_SIZE)]->cells;
+        for (size_t k = 0; k < span; k++) {
+            out[i + k] = map->palette->ids[cells[ryce_map_cell_internal(col + k, row)]];
+        }
+
+        i += span;
+    }
 }
 
 RYCE_PUBLIC RYCE_MapError ryce_init_3d_map(RYCE_3dTextMap *map, size_t length, size_t width, size_t height) {
@@ -186,14 +719,402 @@ RYCE_PUBLIC RYCE_MapError ryce_init_3d_map(RYCE_3dTextMap *map, size_t length, s
         .length = length,
         .width = width,
         .height = height,
+        .chunks_x = (length + RYCE_MAP_CHUNK_SIZE - 1) / RYCE_MAP_CHUNK_SIZE,
+        .chunks_y = (width + RYCE_MAP_CHUNK_SIZE - 1) / RYCE_MAP_CHUNK_SIZE,
     };
 
-    // Allocate the map data to be empty (0).
-    map->data = (RYCE_EntityID *)calloc(length * width * height, sizeof(RYCE_EntityID));
-    if (!map->data) {
+    // Every chunk starts out as the empty sentinel.
+    const size_t count = map->chunks_x * map->chunks_y * height;
+    map->chunks = (RYCE_MapChunk **)malloc(count * sizeof(RYCE_MapChunk *));
+    if (!map->chunks) {
         return RYCE_MAP_INVALID_DATA;
     };
 
+    for (size_t i = 0; i < count; i++) {
+        map->chunks[i] = (RYCE_MapChunk *)&RYCE_MAP_EMPTY_CHUNK;
+    }
+
+    map->palette = ryce_palette_new_internal();
+    if (!map->palette) {
+        ryce_map_free(map);
+        return RYCE_MAP_INVALID_DATA;
+    }
+
+    map->tops = (uint32_t *)calloc(length * width, sizeof(uint32_t));
+    map->versions = (uint64_t *)calloc(count, sizeof(uint64_t));
+    map->journal = (RYCE_MapJournal *)calloc(1, sizeof(RYCE_MapJournal));
+    if (!map->tops || !map->versions || !map->journal) {
+        ryce_map_free(map);
+        return RYCE_MAP_INVALID_DATA;
+    }
+
+    return RYCE_MAP_ERR_NONE;
+}
+
+RYCE_PUBLIC void ryce_map_free(RYCE_3dTextMap *map) {
+    const size_t count = map->chunks_x * map->chunks_y * map->height;
+    for (size_t i = 0; map->chunks != nullptr && i < count; i++) {
+        if (ryce_chunk_owned_internal(map, map->chunks[i])) {
+            free(map->chunks[i]);
+        }
+    }
+
+    free(map->chunks);
+    map->chunks = nullptr;
+    ryce_palette_free_internal(map->palette);
+    map->palette = nullptr;
+    free(map->versions);
+    map->versions = nullptr;
+    free(map->journal);
+    map->journal = nullptr;
+
+    if (map->file != nullptr) {
+        munmap(map->file, map->file_size);
+        close(map->file_fd);
+        map->file = nullptr;
+        map->file_size = 0;
+    } else {
+        free(map->tops);
+    }
+
+    map->tops = nullptr;
+}
+
+RYCE_PRIVATE inline size_t ryce_map_file_align_internal(const size_t offset) {
+    return (offset + 7) & ~(size_t)7;
+}
+
+RYCE_PUBLIC RYCE_MapError ryce_map_load(RYCE_3dTextMap *map, const char *path) {
+    if (!map || !path) {
+        return RYCE_MAP_INVALID_DATA;
+    }
+
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return RYCE_MAP_IO_FAILED;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(RYCE_MapFileHeader)) {
+        close(fd);
+        return RYCE_MAP_BAD_FORMAT;
+    }
+
+    // Private and writable, edits copy the touched pages and never reach the file.
+    const size_t size = (size_t)st.st_size;
+    char *file = (char *)mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (file == MAP_FAILED) {
+        close(fd);
+        return RYCE_MAP_IO_FAILED;
+    }
+
+    const RYCE_MapFileHeader *header = (const RYCE_MapFileHeader *)file;
+    if (memcmp(header->magic, RYCE_MAP_FILE_MAGIC, sizeof(RYCE_MAP_FILE_MAGIC)) != 0 ||
+        header->version != RYCE_MAP_FILE_VERSION || header->byte_order != 0x01020304 ||
+        header->tile_size != sizeof(RYCE_MapTile) || header->chunk_size != RYCE_MAP_CHUNK_SIZE ||
+        header->cell_order != RYCE_MAP_CELL_ORDER ||
+        header->length % 2 == 0 || header->width % 2 == 0 || header->height % 2 == 0 || header->palette_count == 0 ||
+        header->palette_count > (uint64_t)RYCE_MAP_TILE_MAX + 1 || header->length > size ||
+        header->width > size / header->length / sizeof(uint32_t) || header->height > size / sizeof(uint64_t)) {
+        close(fd);
+        munmap(file, size);
+        return RYCE_MAP_BAD_FORMAT;
+    }
+
+    // Every section has to fit before anything is allocated for it. The header bounds keep these products in range.
+    const size_t plane = ((header->length + RYCE_MAP_CHUNK_SIZE - 1) / RYCE_MAP_CHUNK_SIZE) *
+                         ((header->width + RYCE_MAP_CHUNK_SIZE - 1) / RYCE_MAP_CHUNK_SIZE);
+    const size_t palette_at = sizeof(RYCE_MapFileHeader);
+    const size_t index_at = palette_at + (header->palette_count * sizeof(uint64_t));
+    if (index_at > size || header->height > (size - index_at) / sizeof(uint64_t) / plane) {
+        close(fd);
+        munmap(file, size);
+        return RYCE_MAP_BAD_FORMAT;
+    }
+
+    const size_t count = plane * header->height;
+    const size_t columns = header->length * header->width;
+    const size_t tops_at = index_at + (count * sizeof(uint64_t));
+    const size_t chunks_at = ryce_map_file_align_internal(tops_at + (columns * sizeof(uint32_t)));
+    if (chunks_at > size) {
+        close(fd);
+        munmap(file, size);
+        return RYCE_MAP_BAD_FORMAT;
+    }
+
+    RYCE_MapError error = ryce_init_3d_map(map, header->length, header->width, header->height);
+    if (error != RYCE_MAP_ERR_NONE) {
+        close(fd);
+        munmap(file, size);
+        return error;
+    }
+
+    // From here on the mapping and its descriptor belong to the map and are released with it.
+    free(map->tops);
+    map->tops = nullptr;
+    map->file = file;
+    map->file_size = size;
+    map->file_fd = fd;
+
+    // Cover every tile index, so cells pointing past the file's palette read as RYCE_ENTITY_NONE.
+    RYCE_EntityID *ids = (RYCE_EntityID *)calloc((size_t)RYCE_MAP_TILE_MAX + 1, sizeof(RYCE_EntityID));
+    if (!ids) {
+        ryce_map_free(map);
+        return RYCE_MAP_INVALID_DATA;
+    }
+
+    free(map->palette->ids);
+    map->palette->ids = ids;
+    map->palette->capacity = (size_t)RYCE_MAP_TILE_MAX + 1;
+
+    const uint64_t *palette = (const uint64_t *)(file + palette_at);
+    for (size_t i = 1; i < header->palette_count; i++) {
+        RYCE_MapTile tile = 0;
+        error = ryce_palette_intern_internal(map->palette, (RYCE_EntityID)palette[i], &tile);
+        if (error != RYCE_MAP_ERR_NONE || tile != i) {
+            ryce_map_free(map);
+            return error != RYCE_MAP_ERR_NONE ? error : RYCE_MAP_BAD_FORMAT;
+        }
+    }
+
+    const uint64_t *index = (const uint64_t *)(file + index_at);
+    for (size_t i = 0; i < count; i++) {
+        if (index[i] == 0) {
+            continue;
+        } else if (index[i] < chunks_at || index[i] % 8 != 0 || index[i] > size ||
+                   size - index[i] < sizeof(RYCE_MapChunk)) {
+            ryce_map_free(map);
+            return RYCE_MAP_BAD_FORMAT;
+        }
+
+        map->chunks[i] = (RYCE_MapChunk *)(file + index[i]);
+    }
+
+    // Column tops are validated lazily, see ryce_map_top_internal.
+    map->tops = (uint32_t *)(file + tops_at);
+    return RYCE_MAP_ERR_NONE;
+}
+
+RYCE_PRIVATE bool ryce_map_write_internal(const int fd, const void *data, size_t len) {
+    const char *at = (const char *)data;
+    while (len > 0) {
+        const ssize_t written = write(fd, at, len);
+        if (written < 0) {
+            return false;
+        }
+
+        at += written;
+        len -= (size_t)written;
+    }
+
+    return true;
+}
+
+RYCE_PRIVATE bool ryce_map_copy_internal(const RYCE_3dTextMap *map, const int fd, const size_t from, size_t len) {
+    // Copy a run of records from the loaded file in the kernel, write the rest from the mapping if that fails.
+    off_t offset = (off_t)from;
+    while (len > 0) {
+        const ssize_t sent = sendfile(fd, map->file_fd, &offset, len);
+        if (sent <= 0) {
+            return ryce_map_write_internal(fd, (const char *)map->file + offset, len);
+        }
+
+        len -= (size_t)sent;
+    }
+
+    return true;
+}
+
+RYCE_PRIVATE bool ryce_map_sync_dir_internal(const char *path) {
+    // Sync the directory holding `path`, its new entry is what a rename changes.
+    const char *slash = strrchr(path, '/');
+    char *dir = nullptr;
+    if (slash != nullptr) {
+        const size_t len = slash == path ? 1 : (size_t)(slash - path);
+        dir = (char *)malloc(len + 1);
+        if (!dir) {
+            return false;
+        }
+
+        memcpy(dir, path, len);
+        dir[len] = '\0';
+    }
+
+    const int fd = open(dir != nullptr ? dir : ".", O_RDONLY);
+    free(dir);
+    if (fd < 0) {
+        return false;
+    }
+
+    const bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+RYCE_PUBLIC RYCE_MapError ryce_map_save(const RYCE_3dTextMap *map, const char *path) {
+    if (!map || !path || !map->chunks) {
+        return RYCE_MAP_INVALID_DATA;
+    }
+
+    const size_t count = map->chunks_x * map->chunks_y * map->height;
+    RYCE_MapFileHeader header = {
+        .magic = RYCE_MAP_FILE_MAGIC,
+        .version = RYCE_MAP_FILE_VERSION,
+        .byte_order = 0x01020304,
+        .tile_size = sizeof(RYCE_MapTile),
+        .chunk_size = RYCE_MAP_CHUNK_SIZE,
+        .cell_order = RYCE_MAP_CELL_ORDER,
+        .length = map->length,
+        .width = map->width,
+        .height = map->height,
+        .palette_count = map->palette->count,
+    };
+
+    // The palette and the chunk index are written together, one after the other.
+    uint64_t *table = (uint64_t *)calloc(header.palette_count + count, sizeof(uint64_t));
+    if (!table) {
+        return RYCE_MAP_INVALID_DATA;
+    }
+
+    for (size_t i = 0; i < header.palette_count; i++) {
+        table[i] = map->palette->ids[i];
+    }
+
+    // Lay the non-empty chunks out back to back after the fixed sections.
+    uint64_t *index = table + header.palette_count;
+    const size_t tops_at = sizeof(RYCE_MapFileHeader) + ((header.palette_count + count) * sizeof(uint64_t));
+    const size_t tops_len = map->length * map->width * sizeof(uint32_t);
+    const size_t chunks_at = ryce_map_file_align_internal(tops_at + tops_len);
+    size_t offset = chunks_at;
+    for (size_t i = 0; i < count; i++) {
+        if (!ryce_chunk_empty_internal(map->chunks[i])) {
+            index[i] = offset;
+            offset += sizeof(RYCE_MapChunk);
+            header.chunk_count++;
+        }
+    }
+
+    const size_t path_len = strlen(path);
+    char *tmp = (char *)malloc(path_len + sizeof(".tmp"));
+    if (!tmp) {
+        free(table);
+        return RYCE_MAP_INVALID_DATA;
+    }
+
+    memcpy(tmp, path, path_len);
+    memcpy(tmp + path_len, ".tmp", sizeof(".tmp"));
+    const int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        free(table);
+        free(tmp);
+        return RYCE_MAP_IO_FAILED;
+    }
+
+    static const char padding[8] = {0};
+    bool ok = ryce_map_write_internal(fd, &header, sizeof(header)) &&
+              ryce_map_write_internal(fd, table, (header.palette_count + count) * sizeof(uint64_t)) &&
+              ryce_map_write_internal(fd, map->tops, tops_len) &&
+              ryce_map_write_internal(fd, padding, chunks_at - (tops_at + tops_len));
+    // Chunks never edited since the load still match their record in the file, copy them in runs.
+    size_t run_at = 0;
+    size_t run_len = 0;
+    for (size_t i = 0; ok && i < count; i++) {
+        const RYCE_MapChunk *chunk = map->chunks[i];
+        if (index[i] == 0) {
+            continue;
+        } else if (map->versions[i] == 0 && map->file != nullptr && !ryce_chunk_owned_internal(map, chunk)) {
+            const size_t at = (size_t)((const char *)chunk - (const char *)map->file);
+            if (run_len > 0 && at != run_at + run_len) {
+                ok = ryce_map_copy_internal(map, fd, run_at, run_len);
+                run_len = 0;
+            }
+
+            run_at = run_len == 0 ? at : run_at;
+            run_len += sizeof(RYCE_MapChunk);
+            continue;
+        }
+
+        if (run_len > 0) {
+            ok = ryce_map_copy_internal(map, fd, run_at, run_len);
+            run_len = 0;
+        }
+
+        ok = ok && ryce_map_write_internal(fd, chunk, sizeof(RYCE_MapChunk));
+    }
+
+    ok = ok && (run_len == 0 || ryce_map_copy_internal(map, fd, run_at, run_len));
+
+    // Only replace the old file once the new one is fully on disk, then make the rename itself durable.
+    ok = ok && fsync(fd) == 0;
+    ok = (close(fd) == 0) && ok;
+    ok = ok && rename(tmp, path) == 0;
+    if (!ok) {
+        unlink(tmp);
+    } else {
+        ok = ryce_map_sync_dir_internal(path);
+    }
+
+    free(table);
+    free(tmp);
+    return ok ? RYCE_MAP_ERR_NONE : RYCE_MAP_IO_FAILED;
+}
+
+RYCE_PRIVATE RYCE_MapError ryce_map_compact_internal(const RYCE_3dTextMap *map) {
+    // Removed entities keep their tile, renumber the tiles still referenced by a cell and rewrite every chunk.
+    RYCE_MapTile *remap = (RYCE_MapTile *)calloc((size_t)RYCE_MAP_TILE_MAX + 1, sizeof(RYCE_MapTile));
+    RYCE_EntityID *ids = (RYCE_EntityID *)malloc(map->palette->count * sizeof(RYCE_EntityID));
+    if (!remap || !ids) {
+        free(remap);
+        free(ids);
+        return RYCE_MAP_INVALID_DATA;
+    }
+
+    const size_t chunks = map->chunks_x * map->chunks_y * map->height;
+    for (size_t i = 0; i < chunks; i++) {
+        const RYCE_MapChunk *chunk = map->chunks[i];
+        if (ryce_chunk_empty_internal(chunk)) {
+            continue;
+        }
+
+        for (size_t cell = 0; cell < RYCE_MAP_CHUNK_SIZE * RYCE_MAP_CHUNK_SIZE; cell++) {
+            remap[chunk->cells[cell]] = 1;
+        }
+    }
+
+    // Tiles past the palette of a loaded file read as empty, they are cleared with the unused ones.
+    const size_t count = map->palette->count;
+    memcpy(ids, map->palette->ids, count * sizeof(RYCE_EntityID));
+    ryce_palette_clear_internal(map->palette);
+    remap[0] = 0;
+    for (size_t tile = 1; tile <= RYCE_MAP_TILE_MAX; tile++) {
+        if (remap[tile] == 0 || tile >= count || ids[tile] == RYCE_ENTITY_NONE) {
+            remap[tile] = 0;
+        } else {
+            // Never more entries than before, interning cannot fail.
+            ryce_palette_intern_internal(map->palette, ids[tile], &remap[tile]);
+        }
+    }
+
+    memset(map->palette->ids + map->palette->count, 0,
+           (map->palette->capacity - map->palette->count) * sizeof(RYCE_EntityID));
+    for (size_t i = 0; i < chunks; i++) {
+        RYCE_MapChunk *chunk = map->chunks[i];
+        if (ryce_chunk_empty_internal(chunk)) {
+            continue;
+        }
+
+        // Renumbered chunks no longer match their record in a loaded file, count them as edited.
+        bool changed = false;
+        for (size_t cell = 0; cell < RYCE_MAP_CHUNK_SIZE * RYCE_MAP_CHUNK_SIZE; cell++) {
+            changed = changed || chunk->cells[cell] != remap[chunk->cells[cell]];
+            chunk->cells[cell] = remap[chunk->cells[cell]];
+        }
+
+        map->versions[i] += changed;
+    }
+
+    free(remap);
+    free(ids);
     return RYCE_MAP_ERR_NONE;
 }
 
@@ -202,15 +1123,46 @@ RYCE_PUBLIC RYCE_MapError ryce_map_add_entity(const RYCE_3dTextMap *map, const R
         return RYCE_MAP_INVALID_DATA;
     }
 
-    // Translate the 3D coordinates to a 1D index.
-    size_t idx = ryce_translate_vec_internal(map, vec);
-    idx = ryce_math_clamp((int64_t)idx, 0, map->length * map->width * map->height);
-
-    if (map->data[idx] != 0) {
+    // Translate the 3D coordinates to a chunk and a cell.
+    const RYCE_MapCell at = ryce_translate_vec_internal(map, vec);
+    RYCE_MapChunk *chunk = map->chunks[at.chunk];
+    if (chunk->cells[at.cell] != 0) {
         return RYCE_MAP_INVALID_PLACEMENT;
+    } else if (entity == RYCE_ENTITY_NONE) {
+        return RYCE_MAP_ERR_NONE;
+    }
+
+    RYCE_MapTile tile = 0;
+    RYCE_MapError error = ryce_palette_intern_internal(map->palette, entity, &tile);
+    if (error == RYCE_MAP_PALETTE_FULL) {
+        // Reclaim the tiles of entities no longer on the map before giving up.
+        error = ryce_map_compact_internal(map);
+        if (error == RYCE_MAP_ERR_NONE) {
+            error = ryce_palette_intern_internal(map->palette, entity, &tile);
+        }
+    }
+
+    if (error != RYCE_MAP_ERR_NONE) {
+        return error;
+    }
+
+    if (ryce_chunk_empty_internal(chunk)) {
+        // First entity of the chunk.
+        chunk = (RYCE_MapChunk *)calloc(1, sizeof(RYCE_MapChunk));
+        if (!chunk) {
+            return RYCE_MAP_INVALID_DATA;
+        }
+
+        map->chunks[at.chunk] = chunk;
     }
 
-    map->data[idx] = entity;
+    chunk->cells[at.cell] = tile;
+    chunk->count++;
+    if (at.level + 1 > ryce_map_top_internal(map, &at)) {
+        map->tops[at.column] = (uint32_t)(at.level + 1);
+    }
+
+    ryce_map_record_internal(map, &at, RYCE_ENTITY_NONE, entity);
     return RYCE_MAP_ERR_NONE;
 }
 
@@ -220,32 +1172,547 @@ RYCE_PUBLIC RYCE_MapError ryce_map_remove_entity(const RYCE_3dTextMap *map, cons
         return RYCE_MAP_INVALID_DATA;
     }
 
-    // Translate the 3D coordinates to a 1D index.
-    const size_t idx = ryce_translate_vec_internal(map, vec);
-    if (idx >= map->length * map->width * map->height) {
+    // Translate the 3D coordinates to a chunk and a cell.
+    const RYCE_MapCell at = ryce_translate_vec_internal(map, vec);
+    RYCE_MapChunk *chunk = map->chunks[at.chunk];
+    if (map->palette->ids[chunk->cells[at.cell]] != entity) {
+        return RYCE_MAP_ENTITY_NOT_FOUND;
+    } else if (entity == RYCE_ENTITY_NONE) {
+        return RYCE_MAP_ERR_NONE;
+    }
+
+    // Chunks from a loaded file carry an unchecked count, never wrap it.
+    chunk->cells[at.cell] = 0;
+    if (chunk->count > 0 && --chunk->count == 0) {
+        // Last entity of the chunk, hand it back to the sentinel.
+        if (ryce_chunk_owned_internal(map, chunk)) {
+            free(chunk);
+        }
+
+        map->chunks[at.chunk] = (RYCE_MapChunk *)&RYCE_MAP_EMPTY_CHUNK;
+    }
+
+    if (at.level + 1 == ryce_map_top_internal(map, &at)) {
+        // The column lost its top, find the next one down.
+        map->tops[at.column] = at.level > 0 ? ryce_column_scan_internal(map, &at, at.level - 1) : 0;
+    }
+
+    ryce_map_record_internal(map, &at, entity, RYCE_ENTITY_NONE);
+    return RYCE_MAP_ERR_NONE;
+}
+
+RYCE_PUBLIC RYCE_EntityID ryce_map_get_entity(const RYCE_3dTextMap *map, const RYCE_Vec3 *vec) {
+    if (!map || !vec) {
+        return RYCE_ENTITY_NONE;
+    }
+
+    // Translate the 3D coordinates to a chunk and a cell.
+    const RYCE_MapCell at = ryce_translate_vec_internal(map, vec);
+    return map->palette->ids[map->chunks[at.chunk]->cells[at.cell]];
+}
+
+RYCE_PUBLIC uint64_t ryce_map_chunk_version(const RYCE_3dTextMap *map, const RYCE_Vec3 *vec) {
+    if (!map || !vec) {
+        return 0;
+    }
+
+    return map->versions[ryce_translate_vec_internal(map, vec).chunk];
+}
+
+RYCE_PUBLIC uint64_t ryce_map_journal_head(const RYCE_3dTextMap *map) {
+    return map != nullptr ? map->journal->head : 0;
+}
+
+RYCE_PUBLIC RYCE_MapError ryce_map_read_changes(const RYCE_3dTextMap *map, uint64_t *cursor, RYCE_MapChange *out,
+                                                const size_t max_out, size_t *count) {
+    if (!map || !cursor || !count || (!out && max_out > 0) || *cursor > map->journal->head) {
+        return RYCE_MAP_INVALID_DATA;
+    }
+
+    *count = 0;
+    const uint64_t head = map->journal->head;
+    if (head - *cursor > RYCE_MAP_JOURNAL_SIZE) {
+        // The oldest unread changes were overwritten.
+        *cursor = head;
+        return RYCE_MAP_JOURNAL_OVERRUN;
+    }
+
+    for (; *cursor < head && *count < max_out; (*cursor)++, (*count)++) {
+        out[*count] = map->journal->changes[*cursor & (RYCE_MAP_JOURNAL_SIZE - 1)];
+    }
+
+    return RYCE_MAP_ERR_NONE;
+}
+
+RYCE_PUBLIC RYCE_MapError ryce_map_get_top(const RYCE_3dTextMap *map, const RYCE_Vec3 *vec, RYCE_Vec3 *top) {
+    if (!map || !vec || !top) {
+        return RYCE_MAP_INVALID_DATA;
+    }
+
+    const RYCE_MapCell at = ryce_translate_vec_internal(map, vec);
+    const uint32_t level = ryce_map_top_internal(map, &at);
+    if (level == 0) {
+        return RYCE_MAP_ENTITY_NOT_FOUND;
+    }
+
+    *top = (RYCE_Vec3){
+        .x = (int64_t)(at.column % map->length) + map->x.min,
+        .y = (int64_t)(at.column / map->length) + map->y.min,
+        .z = (int64_t)level - 1 + map->z.min,
+    };
+    return RYCE_MAP_ERR_NONE;
+}
+
+RYCE_PUBLIC RYCE_MapError ryce_map_get_top_below(const RYCE_3dTextMap *map, const RYCE_Vec3 *vec, RYCE_Vec3 *top) {
+    if (!map || !vec || !top) {
+        return RYCE_MAP_INVALID_DATA;
+    } else if (vec->z < map->z.min) {
+        return RYCE_MAP_ENTITY_NOT_FOUND;
+    }
+
+    // Only scan when the column's top is above the requested level.
+    const RYCE_MapCell at = ryce_translate_vec_internal(map, vec);
+    uint32_t level = ryce_map_top_internal(map, &at);
+    if (level > at.level + 1) {
+        level = ryce_column_scan_internal(map, &at, at.level);
+    }
+
+    if (level == 0) {
+        return RYCE_MAP_ENTITY_NOT_FOUND;
+    }
+
+    *top = (RYCE_Vec3){
+        .x = (int64_t)(at.column % map->length) + map->x.min,
+        .y = (int64_t)(at.column / map->length) + map->y.min,
+        .z = (int64_t)level - 1 + map->z.min,
+    };
+    return RYCE_MAP_ERR_NONE;
+}
+
+RYCE_PUBLIC RYCE_MapError ryce_map_get_row(const RYCE_3dTextMap *map, const RYCE_Vec3 *start, const size_t count,
+                                           RYCE_EntityID *out) {
+    if (!map || !start || !out) {
+        return RYCE_MAP_INVALID_DATA;
+    }
+
+    ryce_map_read_row_internal(map, start->x - map->x.min, start->y - map->y.min, start->z - map->z.min, count, out);
+    return RYCE_MAP_ERR_NONE;
+}
+
+RYCE_PUBLIC RYCE_MapError ryce_map_get_region(const RYCE_3dTextMap *map, const RYCE_Vec3 *min, const RYCE_Vec3 *max,
+                                              RYCE_EntityID *out, const size_t stride) {
+    if (!map || !min || !max || !out) {
+        return RYCE_MAP_INVALID_DATA;
+    } else if (max->x < min->x || max->y < min->y || max->z < min->z || stride < (size_t)(max->x - min->x + 1)) {
+        return RYCE_MAP_INVALID_DIMENSIONS;
+    }
+
+    const size_t count = (size_t)(max->x - min->x + 1);
+    const size_t rows = (size_t)(max->y - min->y + 1);
+    for (int64_t z = min->z; z <= max->z; z++) {
+        for (int64_t y = min->y; y <= max->y; y++) {
+            RYCE_EntityID *row = out + (((((size_t)(z - min->z)) * rows) + (size_t)(y - min->y)) * stride);
+            ryce_map_read_row_internal(map, min->x - map->x.min, y - map->y.min, z - map->z.min, count, row);
+        }
+    }
+
+    return RYCE_MAP_ERR_NONE;
+}
+
+// --- Streaming Map ------------------------------------------------------ //
+
+RYCE_PRIVATE inline int64_t ryce_floor_div_internal(const int64_t value, const int64_t divisor) {
+    return value >= 0 ? value / divisor : -((-value - 1) / divisor) - 1;
+}
+
+RYCE_PRIVATE inline size_t ryce_stream_home_internal(const RYCE_StreamMap *map, const RYCE_Vec3 *key) {
+    // Mix the three coordinates, then keep the high bits like the palette does.
+    const uint64_t hash = ((uint64_t)key->x * 0x9E3779B97F4A7C15ULL) ^ ((uint64_t)key->y * 0xC2B2AE3D27D4EB4FULL) ^
+                          ((uint64_t)key->z * 0x165667B19E3779F9ULL);
+    return (size_t)((hash * 0x9E3779B97F4A7C15ULL) >> 32) & (map->slots_len - 1);
+}
+
+RYCE_PRIVATE size_t ryce_stream_slot_internal(const RYCE_StreamMap *map, const RYCE_Vec3 *key) {
+    // Probe linearly to the chunk's slot or the first free one.
+    size_t slot = ryce_stream_home_internal(map, key);
+    while (map->slots[slot] != nullptr && (map->slots[slot]->key.x != key->x || map->slots[slot]->key.y != key->y ||
+                                           map->slots[slot]->key.z != key->z)) {
+        slot = (slot + 1) & (map->slots_len - 1);
+    }
+
+    return slot;
+}
+
+RYCE_PRIVATE void ryce_stream_unslot_internal(RYCE_StreamMap *map, size_t slot) {
+    // Backward shift deletion, pull later entries of the probe run into the hole so lookups never need tombstones.
+    const size_t mask = map->slots_len - 1;
+    for (size_t next = (slot + 1) & mask; map->slots[next] != nullptr; next = (next + 1) & mask) {
+        const size_t home = ryce_stream_home_internal(map, &map->slots[next]->key);
+        if (((next - home) & mask) >= ((next - slot) & mask)) {
+            map->slots[slot] = map->slots[next];
+            slot = next;
+        }
+    }
+
+    map->slots[slot] = nullptr;
+}
+
+RYCE_PRIVATE void ryce_stream_unlink_internal(RYCE_StreamMap *map, RYCE_StreamChunk *chunk) {
+    if (chunk->newer != nullptr) {
+        chunk->newer->older = chunk->older;
+    } else {
+        map->newest = chunk->older;
+    }
+
+    if (chunk->older != nullptr) {
+        chunk->older->newer = chunk->newer;
+    } else {
+        map->oldest = chunk->newer;
+    }
+
+    chunk->newer = nullptr;
+    chunk->older = nullptr;
+}
+
+RYCE_PRIVATE void ryce_stream_touch_internal(RYCE_StreamMap *map, RYCE_StreamChunk *chunk) {
+    if (map->newest == chunk) {
+        return;
+    }
+
+    if (chunk->newer != nullptr || chunk->older != nullptr || map->oldest == chunk) {
+        ryce_stream_unlink_internal(map, chunk);
+    }
+
+    chunk->older = map->newest;
+    if (map->newest != nullptr) {
+        map->newest->newer = chunk;
+    } else {
+        map->oldest = chunk;
+    }
+
+    map->newest = chunk;
+}
+
+RYCE_PRIVATE RYCE_MapError ryce_stream_save_internal(RYCE_StreamMap *map, RYCE_StreamChunk *chunk) {
+    if (!chunk->dirty || map->source.save == nullptr) {
+        chunk->dirty = false;
+        return RYCE_MAP_ERR_NONE;
+    }
+
+    for (size_t i = 0; i < RYCE_MAP_CHUNK_SIZE * RYCE_MAP_CHUNK_SIZE; i++) {
+        const size_t cell = ryce_map_cell_internal(i % RYCE_MAP_CHUNK_SIZE, i / RYCE_MAP_CHUNK_SIZE);
+        map->scratch[i] = chunk->palette->ids[chunk->chunk.cells[cell]];
+    }
+
+    const RYCE_Vec3 origin = {
+        .x = chunk->key.x * RYCE_MAP_CHUNK_SIZE,
+        .y = chunk->key.y * RYCE_MAP_CHUNK_SIZE,
+        .z = chunk->key.z,
+    };
+    RYCE_MapError error = map->source.save(map->source.user, &origin, map->scratch);
+    if (error != RYCE_MAP_ERR_NONE) {
+        return error;
+    }
+
+    chunk->dirty = false;
+    return RYCE_MAP_ERR_NONE;
+}
+
+RYCE_PRIVATE RYCE_MapError ryce_stream_fill_internal(RYCE_StreamMap *map, RYCE_StreamChunk *chunk) {
+    // Prefer the stored copy, generate chunks that were never stored.
+    const RYCE_Vec3 origin = {
+        .x = chunk->key.x * RYCE_MAP_CHUNK_SIZE,
+        .y = chunk->key.y * RYCE_MAP_CHUNK_SIZE,
+        .z = chunk->key.z,
+    };
+    RYCE_MapError error = RYCE_MAP_ENTITY_NOT_FOUND;
+    if (map->source.load != nullptr) {
+        error = map->source.load(map->source.user, &origin, map->scratch);
+    }
+
+    if (error == RYCE_MAP_ENTITY_NOT_FOUND) {
+        error = map->source.generate(map->source.user, &origin, map->scratch);
+    }
+
+    if (error != RYCE_MAP_ERR_NONE) {
+        return error;
+    }
+
+    // Recycled chunks drop the entities of their previous cells.
+    chunk->chunk.count = 0;
+    ryce_palette_clear_internal(chunk->palette);
+    for (size_t i = 0; i < RYCE_MAP_CHUNK_SIZE * RYCE_MAP_CHUNK_SIZE; i++) {
+        RYCE_MapTile tile = 0;
+        if (map->scratch[i] != RYCE_ENTITY_NONE) {
+            error = ryce_palette_intern_internal(chunk->palette, map->scratch[i], &tile);
+            if (error != RYCE_MAP_ERR_NONE) {
+                return error;
+            }
+
+            chunk->chunk.count++;
+        }
+
+        chunk->chunk.cells[ryce_map_cell_internal(i % RYCE_MAP_CHUNK_SIZE, i / RYCE_MAP_CHUNK_SIZE)] = tile;
+    }
+
+    return RYCE_MAP_ERR_NONE;
+}
+
+RYCE_PRIVATE RYCE_MapError ryce_stream_compact_internal(RYCE_StreamMap *map, RYCE_StreamChunk *chunk) {
+    // Removed entities keep their tile until the chunk is refilled, rebuild the palette from the cells in use.
+    for (size_t i = 0; i < RYCE_MAP_CHUNK_SIZE * RYCE_MAP_CHUNK_SIZE; i++) {
+        map->scratch[i] = chunk->palette->ids[chunk->chunk.cells[i]];
+    }
+
+    ryce_palette_clear_internal(chunk->palette);
+    for (size_t i = 0; i < RYCE_MAP_CHUNK_SIZE * RYCE_MAP_CHUNK_SIZE; i++) {
+        RYCE_MapTile tile = 0;
+        if (map->scratch[i] != RYCE_ENTITY_NONE) {
+            RYCE_MapError error = ryce_palette_intern_internal(chunk->palette, map->scratch[i], &tile);
+            if (error != RYCE_MAP_ERR_NONE) {
+                return error;
+            }
+        }
+
+        chunk->chunk.cells[i] = tile;
+    }
+
+    return RYCE_MAP_ERR_NONE;
+}
+
+RYCE_PRIVATE void ryce_stream_charge_internal(RYCE_StreamMap *map, RYCE_StreamChunk *chunk) {
+    // Palettes keep their allocation when cleared, charge whatever they hold right now.
+    const size_t charge = sizeof(RYCE_StreamChunk) + sizeof(RYCE_MapPalette) +
+                          (chunk->palette->capacity * sizeof(RYCE_EntityID)) +
+                          (chunk->palette->slots_len * sizeof(RYCE_MapTile));
+    map->used = map->used - chunk->charge + charge;
+    chunk->charge = charge;
+}
+
+RYCE_PRIVATE void ryce_stream_release_internal(RYCE_StreamChunk *chunk) {
+    if (chunk != nullptr) {
+        ryce_palette_free_internal(chunk->palette);
+        free(chunk);
+    }
+}
+
+RYCE_PRIVATE RYCE_MapError ryce_stream_trim_internal(RYCE_StreamMap *map, const size_t reserve,
+                                                     RYCE_StreamChunk **spare) {
+    // Evict the least recently used chunks, once safely stored, until `reserve` more bytes fit. Without a `spare`
+    // the newest chunk always stays, with one the last chunk evicted is handed back for reuse.
+    while (map->oldest != nullptr && map->used + reserve > map->budget &&
+           (spare != nullptr || map->oldest != map->newest)) {
+        RYCE_StreamChunk *chunk = map->oldest;
+        RYCE_MapError error = ryce_stream_save_internal(map, chunk);
+        if (error != RYCE_MAP_ERR_NONE) {
+            return error;
+        }
+
+        ryce_stream_unslot_internal(map, ryce_stream_slot_internal(map, &chunk->key));
+        ryce_stream_unlink_internal(map, chunk);
+        map->used -= chunk->charge;
+        map->resident--;
+        chunk->charge = 0;
+        if (spare != nullptr) {
+            ryce_stream_release_internal(*spare);
+            *spare = chunk;
+        } else {
+            ryce_stream_release_internal(chunk);
+        }
+    }
+
+    return RYCE_MAP_ERR_NONE;
+}
+
+RYCE_PRIVATE RYCE_MapError ryce_stream_chunk_internal(RYCE_StreamMap *map, const RYCE_Vec3 *vec,
+                                                      RYCE_StreamChunk **out, size_t *cell) {
+    const RYCE_Vec3 key = {
+        .x = ryce_floor_div_internal(vec->x, RYCE_MAP_CHUNK_SIZE),
+        .y = ryce_floor_div_internal(vec->y, RYCE_MAP_CHUNK_SIZE),
+        .z = vec->z,
+    };
+    *cell = ryce_map_cell_internal((size_t)(vec->x - (key.x * RYCE_MAP_CHUNK_SIZE)),
+                                   (size_t)(vec->y - (key.y * RYCE_MAP_CHUNK_SIZE)));
+
+    // Consecutive lookups mostly stay in the same chunk.
+    RYCE_StreamChunk *chunk = map->newest;
+    if (chunk != nullptr && chunk->key.x == key.x && chunk->key.y == key.y && chunk->key.z == key.z) {
+        *out = chunk;
+        return RYCE_MAP_ERR_NONE;
+    }
+
+    const size_t slot = ryce_stream_slot_internal(map, &key);
+    if (map->slots[slot] != nullptr) {
+        *out = map->slots[slot];
+        ryce_stream_touch_internal(map, *out);
+        return RYCE_MAP_ERR_NONE;
+    }
+
+    // Make room for at least a bare chunk, recycling the last one evicted.
+    chunk = nullptr;
+    RYCE_MapError error = ryce_stream_trim_internal(map, sizeof(RYCE_StreamChunk), &chunk);
+    if (error == RYCE_MAP_ERR_NONE && chunk == nullptr) {
+        chunk = (RYCE_StreamChunk *)calloc(1, sizeof(RYCE_StreamChunk));
+        if (chunk != nullptr) {
+            chunk->palette = ryce_palette_new_internal();
+        }
+
+        error = chunk != nullptr && chunk->palette != nullptr ? RYCE_MAP_ERR_NONE : RYCE_MAP_INVALID_DATA;
+    }
+
+    if (error == RYCE_MAP_ERR_NONE) {
+        chunk->key = key;
+        chunk->dirty = false;
+        error = ryce_stream_fill_internal(map, chunk);
+    }
+
+    if (error != RYCE_MAP_ERR_NONE) {
+        ryce_stream_release_internal(chunk);
+        return error;
+    }
+
+    map->resident++;
+    ryce_stream_charge_internal(map, chunk);
+    map->slots[ryce_stream_slot_internal(map, &key)] = chunk;
+    ryce_stream_touch_internal(map, chunk);
+    *out = chunk;
+
+    // A large palette can push the map over budget, evict older chunks to make up for it.
+    return ryce_stream_trim_internal(map, 0, nullptr);
+}
+
+RYCE_PUBLIC RYCE_MapError ryce_init_stream_map(RYCE_StreamMap *map, const RYCE_MapSource *source,
+                                               const size_t budget) {
+    if (!map || !source || source->generate == nullptr) {
+        return RYCE_MAP_INVALID_DATA;
+    }
+
+    *map = (RYCE_StreamMap){
+        .source = *source,
+        .budget = budget,
+        .slots_len = 16,
+    };
+
+    // Every chunk is charged at least its own size, which bounds how many can be resident.
+    const size_t most = budget / sizeof(RYCE_StreamChunk) > 0 ? budget / sizeof(RYCE_StreamChunk) : 1;
+    while (map->slots_len < most * 2) {
+        map->slots_len *= 2;
+    }
+
+    map->slots = (RYCE_StreamChunk **)calloc(map->slots_len, sizeof(RYCE_StreamChunk *));
+    map->scratch = (RYCE_EntityID *)malloc(RYCE_MAP_CHUNK_SIZE * RYCE_MAP_CHUNK_SIZE * sizeof(RYCE_EntityID));
+    if (!map->slots || !map->scratch) {
+        ryce_stream_map_free(map);
+        return RYCE_MAP_INVALID_DATA;
+    }
+
+    return RYCE_MAP_ERR_NONE;
+}
+
+RYCE_PUBLIC RYCE_MapError ryce_stream_map_flush(RYCE_StreamMap *map) {
+    if (!map) {
+        return RYCE_MAP_INVALID_DATA;
+    }
+
+    for (RYCE_StreamChunk *chunk = map->newest; chunk != nullptr; chunk = chunk->older) {
+        RYCE_MapError error = ryce_stream_save_internal(map, chunk);
+        if (error != RYCE_MAP_ERR_NONE) {
+            return error;
+        }
+    }
+
+    return RYCE_MAP_ERR_NONE;
+}
+
+RYCE_PUBLIC void ryce_stream_map_free(RYCE_StreamMap *map) {
+    while (map->newest != nullptr) {
+        RYCE_StreamChunk *chunk = map->newest;
+        map->newest = chunk->older;
+        ryce_stream_release_internal(chunk);
+    }
+
+    free(map->slots);
+    free(map->scratch);
+    *map = (RYCE_StreamMap){0};
+}
+
+RYCE_PUBLIC RYCE_MapError ryce_stream_map_add_entity(RYCE_StreamMap *map, const RYCE_Vec3 *vec,
+                                                     const RYCE_EntityID entity) {
+    if (!map || !vec) {
+        return RYCE_MAP_INVALID_DATA;
+    }
+
+    RYCE_StreamChunk *chunk = nullptr;
+    size_t cell = 0;
+    RYCE_MapError error = ryce_stream_chunk_internal(map, vec, &chunk, &cell);
+    if (error != RYCE_MAP_ERR_NONE) {
+        return error;
+    } else if (chunk->chunk.cells[cell] != 0) {
         return RYCE_MAP_INVALID_PLACEMENT;
+    } else if (entity == RYCE_ENTITY_NONE) {
+        return RYCE_MAP_ERR_NONE;
+    }
+
+    RYCE_MapTile tile = 0;
+    error = ryce_palette_intern_internal(chunk->palette, entity, &tile);
+    if (error == RYCE_MAP_PALETTE_FULL) {
+        error = ryce_stream_compact_internal(map, chunk);
+        if (error == RYCE_MAP_ERR_NONE) {
+            error = ryce_palette_intern_internal(chunk->palette, entity, &tile);
+        }
+    }
+
+    // Interning may have grown the palette, charge it before the cell is placed.
+    if (error == RYCE_MAP_ERR_NONE) {
+        ryce_stream_charge_internal(map, chunk);
+        error = ryce_stream_trim_internal(map, 0, nullptr);
+    }
+
+    if (error != RYCE_MAP_ERR_NONE) {
+        return error;
     }
 
-    if (map->data[idx] != entity) {
+    chunk->chunk.cells[cell] = tile;
+    chunk->chunk.count++;
+    chunk->dirty = true;
+    return RYCE_MAP_ERR_NONE;
+}
+
+RYCE_PUBLIC RYCE_MapError ryce_stream_map_remove_entity(RYCE_StreamMap *map, const RYCE_Vec3 *vec,
+                                                        const RYCE_EntityID entity) {
+    if (!map || !vec) {
+        return RYCE_MAP_INVALID_DATA;
+    }
+
+    RYCE_StreamChunk *chunk = nullptr;
+    size_t cell = 0;
+    RYCE_MapError error = ryce_stream_chunk_internal(map, vec, &chunk, &cell);
+    if (error != RYCE_MAP_ERR_NONE) {
+        return error;
+    } else if (chunk->palette->ids[chunk->chunk.cells[cell]] != entity) {
         return RYCE_MAP_ENTITY_NOT_FOUND;
+    } else if (entity == RYCE_ENTITY_NONE) {
+        return RYCE_MAP_ERR_NONE;
     }
 
-    map->data[idx] = 0;
+    chunk->chunk.cells[cell] = 0;
+    chunk->chunk.count--;
+    chunk->dirty = true;
     return RYCE_MAP_ERR_NONE;
 }
 
-RYCE_PUBLIC RYCE_EntityID ryce_map_get_entity(const RYCE_3dTextMap *map, const RYCE_Vec3 *vec) {
+RYCE_PUBLIC RYCE_EntityID ryce_stream_map_get_entity(RYCE_StreamMap *map, const RYCE_Vec3 *vec) {
     if (!map || !vec) {
         return RYCE_ENTITY_NONE;
     }
 
-    // Translate the 3D coordinates to a 1D index.
-    const size_t idx = ryce_translate_vec_internal(map, vec);
-    if (idx >= map->length * map->width * map->height) {
+    RYCE_StreamChunk *chunk = nullptr;
+    size_t cell = 0;
+    if (ryce_stream_chunk_internal(map, vec, &chunk, &cell) != RYCE_MAP_ERR_NONE) {
         return RYCE_ENTITY_NONE;
     }
 
-    return map->data[idx];
+    return chunk->palette->ids[chunk->chunk.cells[cell]];
 }
 
 #endif // RYCE_MAP_IMPL
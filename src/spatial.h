@@ -0,0 +1,465 @@
+#if defined(RYCE_IMPL) && !defined(RYCE_SPATIAL_IMPL)
+#define RYCE_SPATIAL_IMPL
+#endif
+#ifndef RYCE_SPATIAL_H
+/*
+    RyCE Spatial - A single-header, STB-styled spatial hash for dynamic entities.
+
+    USAGE:
+
+    1) In exactly ONE of your .c or .cpp files, do:
+
+       #define RYCE_SPATIAL_IMPL
+       #include "spatial.h"
+
+    2) In as many other files as you need, just #include "spatial.h"
+       WITHOUT defining RYCE_SPATIAL_IMPL.
+
+    3) Compile and link all files together.
+*/
+#define RYCE_SPATIAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ---------------------------------------------------------------------//
+// BEGIN VISIBILITY MACROS
+#ifndef RYCE_PUBLIC_DECL
+#define RYCE_PUBLIC_DECL extern
+#endif // RYCE_PUBLIC
+
+#ifndef RYCE_PUBLIC
+#define RYCE_PUBLIC
+#endif // RYCE_PUBLIC
+
+#ifndef RYCE_PRIVATE
+#if defined(__GNUC__) || defined(__clang__)
+#define RYCE_PRIVATE __attribute__((unused)) static
+#else
+#define RYCE_PRIVATE static
+#endif
+#endif // RYCE_PRIVATE
+
+#ifndef RYCE_UNUSED
+#define RYCE_UNUSED(x) (void)(x)
+#endif // RYCE_UNUSED
+// END VISIBILITY MACROS
+// ---------------------------------------------------------------------//
+
+// Error Codes.
+typedef enum RYCE_SpatialError {
+    RYCE_SPATIAL_ERR_NONE,       ///< No error.
+    RYCE_SPATIAL_INVALID_DATA,   ///< Invalid data or out of memory.
+    RYCE_SPATIAL_INVALID_HANDLE, ///< Handle does not refer to a live node.
+} RYCE_SpatialError;
+
+/*
+    Public API Structs
+*/
+
+#ifndef RYCE_ENTITY
+#define RYCE_ENTITY
+typedef size_t RYCE_EntityID;
+const RYCE_EntityID RYCE_ENTITY_NONE = 0;
+#endif // RYCE_ENTITY
+
+#ifndef RYCE_VEC3
+#define RYCE_VEC3
+typedef struct RYCE_Vec3 {
+    int64_t x; // X-coordinate.
+    int64_t y; // Y-coordinate.
+    int64_t z; // Z-coordinate.
+} RYCE_Vec3;
+#endif // RYCE_VEC3
+
+#ifndef RYCE_SPATIAL_CELL_SHIFT
+#define RYCE_SPATIAL_CELL_SHIFT 3 // Buckets cover 2^shift cells along X and Y, one level along Z.
+#endif // RYCE_SPATIAL_CELL_SHIFT
+
+#define RYCE_SPATIAL_NONE UINT32_MAX // No node.
+
+typedef uint32_t RYCE_SpatialHandle; // Index of a node in the pool, stable until the node is removed.
+
+typedef struct RYCE_SpatialNode {
+    RYCE_EntityID entity; //< Entity of the node.
+    RYCE_Vec3 pos;        //< Position of the entity.
+    uint32_t bucket;      //< Bucket holding the node, RYCE_SPATIAL_NONE while the node is free.
+    uint32_t prev;        //< Previous node in the bucket.
+    uint32_t next;        //< Next node in the bucket, or in the free list.
+} RYCE_SpatialNode;
+
+typedef struct RYCE_SpatialHash {
+    size_t buckets_len;      //< Length of buckets, a power of two, doubled once count reaches it.
+    uint32_t *buckets;       //< First node of each bucket.
+    size_t capacity;         //< Nodes in the pool.
+    size_t count;            //< Nodes in use.
+    uint32_t free;           //< First free node.
+    RYCE_SpatialNode *nodes; //< Node pool, grown by doubling, handles index into it.
+} RYCE_SpatialHash;
+
+/*
+    Public API Functions
+*/
+
+/**
+ * @brief Initializes a spatial hash. Release it with `ryce_spatial_free`. The node pool and the buckets both double
+ * as entities are added, so `expected` is only a starting size.
+ *
+ * @param hash Spatial hash to initialize.
+ * @param expected Number of entities expected, sizes the buckets and the initial pool.
+ * @return RYCE_SpatialError RYCE_SPATIAL_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_SpatialError ryce_init_spatial_hash(RYCE_SpatialHash *hash, size_t expected);
+
+/**
+ * @brief Frees the buckets and the node pool of a spatial hash.
+ *
+ * @param hash Spatial hash to free.
+ */
+RYCE_PUBLIC_DECL void ryce_spatial_free(RYCE_SpatialHash *hash);
+
+/**
+ * @brief Adds an entity at a position. Several entities may share a cell.
+ *
+ * @param hash Spatial hash to add to.
+ * @param entity Entity to add.
+ * @param pos Position of the entity.
+ * @param out Set to the handle of the new node.
+ * @return RYCE_SpatialError RYCE_SPATIAL_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_SpatialError ryce_spatial_insert(RYCE_SpatialHash *hash, RYCE_EntityID entity,
+                                                       const RYCE_Vec3 *pos, RYCE_SpatialHandle *out);
+
+/**
+ * @brief Removes a node, its handle may be reused by a later insert.
+ *
+ * @param hash Spatial hash to remove from.
+ * @param handle Node to remove.
+ * @return RYCE_SpatialError RYCE_SPATIAL_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_SpatialError ryce_spatial_remove(RYCE_SpatialHash *hash, RYCE_SpatialHandle handle);
+
+/**
+ * @brief Moves a node. Only relinks it when it leaves its bucket's cell.
+ *
+ * @param hash Spatial hash holding the node.
+ * @param handle Node to move.
+ * @param pos New position.
+ * @return RYCE_SpatialError RYCE_SPATIAL_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_SpatialError ryce_spatial_move(RYCE_SpatialHash *hash, RYCE_SpatialHandle handle,
+                                                     const RYCE_Vec3 *pos);
+
+/**
+ * @brief Finds the nodes inside a box, both corners inclusive.
+ *
+ * @param hash Spatial hash to search.
+ * @param min Lowest corner.
+ * @param max Highest corner.
+ * @param out Filled with up to `max_out` handles.
+ * @param max_out Length of `out`.
+ * @return size_t Number of nodes inside the box, more than `max_out` if `out` was too short.
+ */
+RYCE_PUBLIC_DECL size_t ryce_spatial_query_rect(const RYCE_SpatialHash *hash, const RYCE_Vec3 *min,
+                                                const RYCE_Vec3 *max, RYCE_SpatialHandle *out, size_t max_out);
+
+/**
+ * @brief Finds the nodes within a Euclidean distance of a point.
+ *
+ * @param hash Spatial hash to search.
+ * @param center Point to measure from.
+ * @param radius Largest distance included.
+ * @param out Filled with up to `max_out` handles.
+ * @param max_out Length of `out`.
+ * @return size_t Number of nodes in range, more than `max_out` if `out` was too short.
+ */
+RYCE_PUBLIC_DECL size_t ryce_spatial_query_radius(const RYCE_SpatialHash *hash, const RYCE_Vec3 *center,
+                                                  int64_t radius, RYCE_SpatialHandle *out, size_t max_out);
+
+/*===========================================================================
+   ▗▄▄▄▖▗▖  ▗▖▗▄▄▖ ▗▖   ▗▄▄▄▖▗▖  ▗▖▗▄▄▄▖▗▖  ▗▖▗▄▄▄▖ ▗▄▖ ▗▄▄▄▖▗▄▄▄▖ ▗▄▖ ▗▖  ▗▖
+     █  ▐▛▚▞▜▌▐▌ ▐▌▐▌   ▐▌   ▐▛▚▞▜▌▐▌   ▐▛▚▖▐▌  █  ▐▌ ▐▌  █    █  ▐▌ ▐▌▐▛▚▖▐▌
+     █  ▐▌  ▐▌▐▛▀▘ ▐▌   ▐▛▀▀▘▐▌  ▐▌▐▛▀▀▘▐▌ ▝▜▌  █  ▐▛▀▜▌  █    █  ▐▌ ▐▌▐▌ ▝▜▌
+   ▗▄█▄▖▐▌  ▐▌▐▌   ▐▙▄▄▖▐▙▄▄▖▐▌  ▐▌▐▙▄▄▖▐▌  ▐▌  █  ▐▌ ▐▌  █  ▗▄█▄▖▝▚▄▞▘▐▌  ▐▌
+   IMPLEMENTATION
+   Provide function definitions only if RYCE_SPATIAL_IMPL is defined.
+  ===========================================================================*/
+#ifdef RYCE_SPATIAL_IMPL
+
+#include <stdlib.h>
+
+RYCE_PRIVATE inline int64_t ryce_spatial_cell_internal(const int64_t value) {
+    // Floor of value / 2^shift, also for negative values.
+    return value >= 0 ? value >> RYCE_SPATIAL_CELL_SHIFT : ~((~value) >> RYCE_SPATIAL_CELL_SHIFT);
+}
+
+RYCE_PRIVATE inline uint32_t ryce_spatial_bucket_internal(const RYCE_SpatialHash *hash, const int64_t cx,
+                                                          const int64_t cy, const int64_t cz) {
+    const uint64_t key = ((uint64_t)cx * 0x9E3779B97F4A7C15ULL) ^ ((uint64_t)cy * 0xC2B2AE3D27D4EB4FULL) ^
+                         ((uint64_t)cz * 0x165667B19E3779F9ULL);
+    return (uint32_t)(((key * 0x9E3779B97F4A7C15ULL) >> 32) & (hash->buckets_len - 1));
+}
+
+RYCE_PRIVATE inline bool ryce_spatial_in_cell_internal(const RYCE_SpatialNode *node, const int64_t cx,
+                                                       const int64_t cy, const int64_t cz) {
+    // Buckets are shared by unrelated cells, a node only answers for its own.
+    return ryce_spatial_cell_internal(node->pos.x) == cx && ryce_spatial_cell_internal(node->pos.y) == cy &&
+           node->pos.z == cz;
+}
+
+RYCE_PRIVATE void ryce_spatial_link_internal(RYCE_SpatialHash *hash, const uint32_t handle) {
+    RYCE_SpatialNode *node = &hash->nodes[handle];
+    node->bucket = ryce_spatial_bucket_internal(hash, ryce_spatial_cell_internal(node->pos.x),
+                                                ryce_spatial_cell_internal(node->pos.y), node->pos.z);
+    node->prev = RYCE_SPATIAL_NONE;
+    node->next = hash->buckets[node->bucket];
+    if (node->next != RYCE_SPATIAL_NONE) {
+        hash->nodes[node->next].prev = handle;
+    }
+
+    hash->buckets[node->bucket] = handle;
+}
+
+RYCE_PRIVATE void ryce_spatial_unlink_internal(RYCE_SpatialHash *hash, const uint32_t handle) {
+    RYCE_SpatialNode *node = &hash->nodes[handle];
+    if (node->prev != RYCE_SPATIAL_NONE) {
+        hash->nodes[node->prev].next = node->next;
+    } else {
+        hash->buckets[node->bucket] = node->next;
+    }
+
+    if (node->next != RYCE_SPATIAL_NONE) {
+        hash->nodes[node->next].prev = node->prev;
+    }
+}
+
+RYCE_PRIVATE RYCE_SpatialError ryce_spatial_grow_internal(RYCE_SpatialHash *hash, const size_t capacity) {
+    if (capacity >= RYCE_SPATIAL_NONE) {
+        return RYCE_SPATIAL_INVALID_DATA;
+    }
+
+    RYCE_SpatialNode *nodes = (RYCE_SpatialNode *)realloc(hash->nodes, capacity * sizeof(RYCE_SpatialNode));
+    if (!nodes) {
+        return RYCE_SPATIAL_INVALID_DATA;
+    }
+
+    // Thread the new nodes onto the free list, lowest handle first.
+    for (size_t i = capacity; i-- > hash->capacity;) {
+        nodes[i] = (RYCE_SpatialNode){.bucket = RYCE_SPATIAL_NONE, .next = hash->free};
+        hash->free = (uint32_t)i;
+    }
+
+    hash->nodes = nodes;
+    hash->capacity = capacity;
+    return RYCE_SPATIAL_ERR_NONE;
+}
+
+RYCE_PRIVATE RYCE_SpatialError ryce_spatial_rehash_internal(RYCE_SpatialHash *hash, const size_t buckets_len) {
+    uint32_t *buckets = (uint32_t *)malloc(buckets_len * sizeof(uint32_t));
+    if (!buckets) {
+        return RYCE_SPATIAL_INVALID_DATA;
+    }
+
+    for (size_t i = 0; i < buckets_len; i++) {
+        buckets[i] = RYCE_SPATIAL_NONE;
+    }
+
+    free(hash->buckets);
+    hash->buckets = buckets;
+    hash->buckets_len = buckets_len;
+
+    // Handles stay put, only the chains are rebuilt.
+    for (uint32_t handle = 0; handle < hash->capacity; handle++) {
+        if (hash->nodes[handle].bucket != RYCE_SPATIAL_NONE) {
+            ryce_spatial_link_internal(hash, handle);
+        }
+    }
+
+    return RYCE_SPATIAL_ERR_NONE;
+}
+
+RYCE_PRIVATE inline bool ryce_spatial_live_internal(const RYCE_SpatialHash *hash, const RYCE_SpatialHandle handle) {
+    return handle < hash->capacity && hash->nodes[handle].bucket != RYCE_SPATIAL_NONE;
+}
+
+RYCE_PRIVATE inline bool ryce_spatial_accept_internal(const RYCE_SpatialNode *node, const RYCE_Vec3 *min,
+                                                      const RYCE_Vec3 *max, const RYCE_Vec3 *center,
+                                                      const int64_t radius) {
+    const RYCE_Vec3 *pos = &node->pos;
+    if (pos->x < min->x || pos->x > max->x || pos->y < min->y || pos->y > max->y || pos->z < min->z ||
+        pos->z > max->z) {
+        return false;
+    } else if (center == nullptr) {
+        return true;
+    }
+
+    const int64_t dx = pos->x - center->x;
+    const int64_t dy = pos->y - center->y;
+    const int64_t dz = pos->z - center->z;
+    return (dx * dx) + (dy * dy) + (dz * dz) <= radius * radius;
+}
+
+RYCE_PRIVATE size_t ryce_spatial_collect_internal(const RYCE_SpatialHash *hash, const RYCE_Vec3 *min,
+                                                  const RYCE_Vec3 *max, const RYCE_Vec3 *center, const int64_t radius,
+                                                  RYCE_SpatialHandle *out, const size_t max_out) {
+    const int64_t cx0 = ryce_spatial_cell_internal(min->x);
+    const int64_t cx1 = ryce_spatial_cell_internal(max->x);
+    const int64_t cy0 = ryce_spatial_cell_internal(min->y);
+    const int64_t cy1 = ryce_spatial_cell_internal(max->y);
+    const double cells = (double)(cx1 - cx0 + 1) * (double)(cy1 - cy0 + 1) * (double)(max->z - min->z + 1);
+
+    size_t found = 0;
+    if (cells > (double)hash->capacity) {
+        // The box covers more cells than there are nodes, scanning the pool is cheaper.
+        for (uint32_t handle = 0; handle < hash->capacity; handle++) {
+            const RYCE_SpatialNode *node = &hash->nodes[handle];
+            if (node->bucket != RYCE_SPATIAL_NONE && ryce_spatial_accept_internal(node, min, max, center, radius)) {
+                if (found < max_out) {
+                    out[found] = handle;
+                }
+
+                found++;
+            }
+        }
+
+        return found;
+    }
+
+    for (int64_t cz = min->z; cz <= max->z; cz++) {
+        for (int64_t cy = cy0; cy <= cy1; cy++) {
+            for (int64_t cx = cx0; cx <= cx1; cx++) {
+                uint32_t handle = hash->buckets[ryce_spatial_bucket_internal(hash, cx, cy, cz)];
+                for (; handle != RYCE_SPATIAL_NONE; handle = hash->nodes[handle].next) {
+                    const RYCE_SpatialNode *node = &hash->nodes[handle];
+                    if (ryce_spatial_in_cell_internal(node, cx, cy, cz) &&
+                        ryce_spatial_accept_internal(node, min, max, center, radius)) {
+                        if (found < max_out) {
+                            out[found] = handle;
+                        }
+
+                        found++;
+                    }
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+RYCE_PUBLIC RYCE_SpatialError ryce_init_spatial_hash(RYCE_SpatialHash *hash, const size_t expected) {
+    if (!hash) {
+        return RYCE_SPATIAL_INVALID_DATA;
+    }
+
+    *hash = (RYCE_SpatialHash){.buckets_len = 64, .free = RYCE_SPATIAL_NONE};
+    while (hash->buckets_len < expected && hash->buckets_len < ((size_t)1 << 31)) {
+        hash->buckets_len *= 2;
+    }
+
+    hash->buckets = (uint32_t *)malloc(hash->buckets_len * sizeof(uint32_t));
+    if (!hash->buckets || ryce_spatial_grow_internal(hash, expected > 16 ? expected : 16) != RYCE_SPATIAL_ERR_NONE) {
+        ryce_spatial_free(hash);
+        return RYCE_SPATIAL_INVALID_DATA;
+    }
+
+    for (size_t i = 0; i < hash->buckets_len; i++) {
+        hash->buckets[i] = RYCE_SPATIAL_NONE;
+    }
+
+    return RYCE_SPATIAL_ERR_NONE;
+}
+
+RYCE_PUBLIC void ryce_spatial_free(RYCE_SpatialHash *hash) {
+    free(hash->buckets);
+    free(hash->nodes);
+    *hash = (RYCE_SpatialHash){.free = RYCE_SPATIAL_NONE};
+}
+
+RYCE_PUBLIC RYCE_SpatialError ryce_spatial_insert(RYCE_SpatialHash *hash, const RYCE_EntityID entity,
+                                                  const RYCE_Vec3 *pos, RYCE_SpatialHandle *out) {
+    if (!hash || !pos || !out) {
+        return RYCE_SPATIAL_INVALID_DATA;
+    } else if (hash->free == RYCE_SPATIAL_NONE) {
+        RYCE_SpatialError error = ryce_spatial_grow_internal(hash, hash->capacity * 2);
+        if (error != RYCE_SPATIAL_ERR_NONE) {
+            return error;
+        }
+    }
+
+    if (hash->count >= hash->buckets_len && hash->buckets_len < ((size_t)1 << 31)) {
+        // Keep about one node per bucket so chains stay short as the hash fills up.
+        RYCE_SpatialError error = ryce_spatial_rehash_internal(hash, hash->buckets_len * 2);
+        if (error != RYCE_SPATIAL_ERR_NONE) {
+            return error;
+        }
+    }
+
+    const uint32_t handle = hash->free;
+    hash->free = hash->nodes[handle].next;
+    hash->nodes[handle].entity = entity;
+    hash->nodes[handle].pos = *pos;
+    ryce_spatial_link_internal(hash, handle);
+    hash->count++;
+    *out = handle;
+    return RYCE_SPATIAL_ERR_NONE;
+}
+
+RYCE_PUBLIC RYCE_SpatialError ryce_spatial_remove(RYCE_SpatialHash *hash, const RYCE_SpatialHandle handle) {
+    if (!hash) {
+        return RYCE_SPATIAL_INVALID_DATA;
+    } else if (!ryce_spatial_live_internal(hash, handle)) {
+        return RYCE_SPATIAL_INVALID_HANDLE;
+    }
+
+    ryce_spatial_unlink_internal(hash, handle);
+    hash->nodes[handle] = (RYCE_SpatialNode){.bucket = RYCE_SPATIAL_NONE, .next = hash->free};
+    hash->free = handle;
+    hash->count--;
+    return RYCE_SPATIAL_ERR_NONE;
+}
+
+RYCE_PUBLIC RYCE_SpatialError ryce_spatial_move(RYCE_SpatialHash *hash, const RYCE_SpatialHandle handle,
+                                                const RYCE_Vec3 *pos) {
+    if (!hash || !pos) {
+        return RYCE_SPATIAL_INVALID_DATA;
+    } else if (!ryce_spatial_live_internal(hash, handle)) {
+        return RYCE_SPATIAL_INVALID_HANDLE;
+    }
+
+    RYCE_SpatialNode *node = &hash->nodes[handle];
+    const bool same_cell = ryce_spatial_in_cell_internal(node, ryce_spatial_cell_internal(pos->x),
+                                                         ryce_spatial_cell_internal(pos->y), pos->z);
+    if (same_cell) {
+        node->pos = *pos;
+        return RYCE_SPATIAL_ERR_NONE;
+    }
+
+    ryce_spatial_unlink_internal(hash, handle);
+    node->pos = *pos;
+    ryce_spatial_link_internal(hash, handle);
+    return RYCE_SPATIAL_ERR_NONE;
+}
+
+RYCE_PUBLIC size_t ryce_spatial_query_rect(const RYCE_SpatialHash *hash, const RYCE_Vec3 *min, const RYCE_Vec3 *max,
+                                           RYCE_SpatialHandle *out, const size_t max_out) {
+    if (!hash || !min || !max || (!out && max_out > 0) || max->x < min->x || max->y < min->y || max->z < min->z) {
+        return 0;
+    }
+
+    return ryce_spatial_collect_internal(hash, min, max, nullptr, 0, out, max_out);
+}
+
+RYCE_PUBLIC size_t ryce_spatial_query_radius(const RYCE_SpatialHash *hash, const RYCE_Vec3 *center,
+                                             const int64_t radius, RYCE_SpatialHandle *out, const size_t max_out) {
+    if (!hash || !center || (!out && max_out > 0) || radius < 0) {
+        return 0;
+    }
+
+    const RYCE_Vec3 min = {center->x - radius, center->y - radius, center->z - radius};
+    const RYCE_Vec3 max = {center->x + radius, center->y + radius, center->z + radius};
+    return ryce_spatial_collect_internal(hash, &min, &max, center, radius, out, max_out);
+}
+
+#endif // RYCE_SPATIAL_IMPL
+#endif // RYCE_SPATIAL_H
@@ -24,20 +24,38 @@
         - RYCE_TuiContext
     - Functions:
         - ryce_init_pane
+        - ryce_resize_pane
+        - ryce_pane_set_z
+        - ryce_free_pane
         - ryce_init_tui_ctx
+        - ryce_resize_tui_ctx
+        - ryce_tui_free_ctx
+        - ryce_tui_set_sink
+        - ryce_tui_set_rep
+        - ryce_tui_flush
+        - ryce_tui_get_stats
+        - ryce_tui_start_render_thread
+        - ryce_tui_stop_render_thread
         - ryce_render_tui
         - ryce_pane_set
         - ryce_pane_set_str
+        - ryce_pane_blit
+        - ryce_pane_fill
+        - ryce_pane_scroll
+        - ryce_pane_mark_dirty
         - ryce_move_cursor
         - ryce_clear_screen
         - ryce_clear_pane
 */
 #define RYCE_TUI_H
 
+#include <pthread.h>   // pthread_t, pthread_create, pthread_join
+#include <stdatomic.h> // atomic_bool, atomic_int, atomic_uint
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h> // timespec, clock_gettime, nanosleep
 
 // ---------------------------------------------------------------------//
 // BEGIN VISIBILITY MACROS
@@ -84,6 +102,9 @@
 #define RYCE_NUM_FMT RYCE_LITERAL("%lu")
 #define RYCE_STR_FMT RYCE_LITERAL("%ls")
 
+// UTF-8 encoding of the CSI (U+009B) written by the renderer.
+#define RYCE_CSI_BYTES "\xc2\x9b"
+
 #else
 
 #define RYCE_CHAR char
@@ -99,6 +120,9 @@
 #define RYCE_NUM_FMT RYCE_LITERAL("%zu")
 #define RYCE_STR_FMT RYCE_LITERAL("%s")
 
+// Raw CSI byte written by the renderer.
+#define RYCE_CSI_BYTES "\x9b"
+
 #endif // RYCE_WIDE_CHAR_SUPPORT
 
 // String / Character constants and formatters.
@@ -106,34 +130,28 @@
 
 // ANSI escape sequences.
 #define RYCE_CSI RYCE_LITERAL("\x9b")
-#define RYCE_MOVE_ANSI RYCE_CSI RYCE_NUM_FMT RYCE_LITERAL(";") RYCE_NUM_FMT RYCE_LITERAL("H")
 #define RYCE_HIDE_CURSOR_ANSI RYCE_CSI RYCE_LITERAL("?25l")
 #define RYCE_UNHIDE_CURSOR_ANSI RYCE_CSI RYCE_LITERAL("?25h")
-#define RYCE_BUFFER_FMT RYCE_STR_FMT RYCE_MOVE_ANSI
 
 #ifndef RYCE_ZERO
 #define RYCE_ZERO 0
 #endif // RYCE_ZERO
 
 // ---------------------------------------------------------------------//
-// BEGIN Screen Size & Buffer Definititons.
-#ifndef RYCE_SCREEN_WIDTH
-#define RYCE_SCREEN_WIDTH 256
-#endif // RYCE_SCREEN_WIDTH
-
-#ifndef RYCE_SCREEN_HEIGHT
-#define RYCE_SCREEN_HEIGHT 256
-#endif // RYCE_SCREEN_HEIGHT
-
-#define RYCE_SCREEN_BUFFER_CAPACITY (size_t)(RYCE_SCREEN_WIDTH * RYCE_SCREEN_HEIGHT)
-#define RYCE_WRITE_BUFFER_CAPACITY (RYCE_SCREEN_BUFFER_CAPACITY * 3)
-// END Screen Size & Buffer Definititons.
+// BEGIN Buffer Definititons.
+// Initial characters reserved in the write buffer per screen cell, the buffer grows on demand.
+#ifndef RYCE_WRITE_BUFFER_SCALE
+#define RYCE_WRITE_BUFFER_SCALE 3
+#endif // RYCE_WRITE_BUFFER_SCALE
+// END Buffer Definititons.
 // ---------------------------------------------------------------------//
 
 // Numeric Contants
 enum {
     RYCE_ANSI_MOVE_COST = 3,         //< Cost of moving the cursor in ANSI escape sequences.
     RYCE_ANSI_CODE_BUFFER_SIZE = 64, //< Size of the ansi code buffer.
+    RYCE_FRAME_COUNT = 3,            //< Frames used to hand off renders to the render thread.
+    RYCE_FRAME_FRESH = 1 << 2,       //< Flag on a published frame index that has not been rendered yet.
 };
 
 // Error Codes.
@@ -148,6 +166,8 @@ typedef enum RYCE_TuiError {
     RYCE_TUI_ERR_UNKNOWN_STYLE,         //< Unknown style flag.
     RYCE_TUI_ERR_INVALID_DIMENSIONS,    //< Invalid dimensions.
     RYCE_TUI_ERR_INVALID_COORDINATES,   //< Invalid coordinates.
+    RYCE_TUI_ERR_ALLOCATE_BUFFER,       //< Failed to allocate a buffer.
+    RYCE_TUI_ERR_RENDER_THREAD_RUNNING, //< The render thread owns the output.
 } RYCE_TuiError;
 
 // ANSI Color Codes.
@@ -198,6 +218,43 @@ typedef struct RYCE_Glyph {
     RYCE_Style style; ///< Style of the character.
 } RYCE_Glyph;
 
+typedef struct RYCE_DirtySpan {
+    uint32_t start; ///< First dirty column (inclusive).
+    uint32_t end;   ///< Last dirty column (exclusive).
+} RYCE_DirtySpan;
+
+typedef struct RYCE_ScrollRegion {
+    uint32_t x;      ///< X coordinate of the region.
+    uint32_t y;      ///< Y coordinate of the region.
+    uint32_t width;  ///< Width of the region.
+    uint32_t height; ///< Height of the region.
+    int32_t dx;      ///< Columns the contents moved by, positive moves right.
+    int32_t dy;      ///< Rows the contents moved by, positive moves down.
+} RYCE_ScrollRegion;
+
+typedef struct RYCE_Frame {
+    RYCE_Glyph *glyphs;       ///< Snapshot of the update buffer. [width * height]
+    RYCE_DirtySpan *dirty;    ///< Columns per row that changed since the previous snapshot. [height]
+    RYCE_ScrollRegion scroll; ///< Scroll to apply to the terminal before drawing the snapshot.
+} RYCE_Frame;
+
+typedef struct RYCE_TuiStats {
+    uint64_t frames;   ///< Frames written to the output so far.
+    uint64_t skipped;  ///< Renders skipped so far because the terminal was behind.
+    uint64_t cells;    ///< Cells that changed in the last frame.
+    uint64_t bytes;    ///< Bytes the last frame wrote.
+    uint64_t styles;   ///< Style sequences the last frame wrote.
+    uint64_t moves;    ///< Cursor move sequences the last frame wrote.
+    uint64_t reprints; ///< Cursor moves the last frame replaced by reprinting the skipped cells.
+    uint64_t diff_ns;  ///< Nanoseconds the last frame spent diffing and encoding.
+    uint64_t flush_ns; ///< Nanoseconds the last frame spent handing its bytes to the output.
+} RYCE_TuiStats;
+
+/**
+ * @brief Receives the encoded bytes of each render, `user` is the pointer given to `ryce_tui_set_sink`.
+ */
+typedef RYCE_TuiError (*RYCE_TuiSink)(void *user, const char *buffer, size_t length);
+
 typedef struct RYCE_TuiContext {
     struct {
         int64_t x;       ///< X coordinate.
@@ -206,30 +263,71 @@ typedef struct RYCE_TuiContext {
         uint32_t height; ///< Height.
     } view;              ///< View rectangle.
     struct {
-        int64_t x; ///< X position.
+        int64_t x; ///< X position, the column the next character is written to.
         int64_t y; ///< Y position.
     } cursor;
     RYCE_Style style;                                  ///< Current style.
-    size_t pane_count;                                 ///< Number of panes.
-    RYCE_CHAR ansi_buffer[RYCE_ANSI_CODE_BUFFER_SIZE]; ///< Buffer to store move sequences.
+    bool clear;                                        ///< Clear the terminal before the next render.
+    bool rep;                                          ///< Terminal supports REP, off until `ryce_tui_set_rep`.
+    size_t pane_count;                                 ///< Number of panes created, used to hand out IDs.
+    char ansi_buffer[RYCE_ANSI_CODE_BUFFER_SIZE]; ///< Buffer to store style sequences.
     struct {
-        uint64_t length;                              ///< Current length of the write_buffer.
-        RYCE_CHAR buffer[RYCE_WRITE_BUFFER_CAPACITY]; ///< Buffer that stores differences to be written.
+        uint64_t length;   ///< Current length of the write_buffer in bytes.
+        uint64_t capacity; ///< Allocated length of the write_buffer in bytes.
+        char *buffer;      ///< UTF-8 encoded differences to be written.
     } write;
-    RYCE_Glyph update[RYCE_SCREEN_BUFFER_CAPACITY];  ///< Current modified buffer.
-    RYCE_Glyph cache[RYCE_SCREEN_BUFFER_CAPACITY];   ///< Last rendered buffer.
-    size_t render_mask[RYCE_SCREEN_BUFFER_CAPACITY]; ///< Mask to track rendered cells.
+    RYCE_DirtySpan *dirty; ///< Columns per row that differ from the last render. [height]
+    RYCE_Glyph *update;    ///< Current modified buffer. [width * height]
+    RYCE_Glyph *cache;     ///< Last rendered buffer. [width * height]
+    RYCE_DirtySpan *damage; ///< Columns per row the panes changed since the last composite. [height]
+    uint64_t *changed;     ///< Changed-cell bitmask of the row being rendered. [(width + 63) / 64]
+    RYCE_ScrollRegion scroll; ///< Scroll accumulated since the last render.
+    struct {
+        struct RYCE_Pane **items; ///< Attached panes, sorted from the bottom to the top.
+        size_t count;             ///< Number of attached panes.
+        size_t capacity;          ///< Allocated length of items.
+    } panes;
+    uint64_t generation;      ///< Advanced by every render, the dirty spans of older generations were consumed.
+    struct {
+        RYCE_TuiSink write; ///< Destination of rendered output, stdout when null.
+        void *user;         ///< Pointer handed to the sink.
+    } sink;
+    struct {
+        int fd;          ///< Non-blocking descriptor of the terminal, -1 to write to stdout blocking.
+        uint64_t offset; ///< Bytes of the queue already written.
+        uint64_t length; ///< Bytes in the queue.
+        uint64_t capacity; ///< Allocated bytes of the queue.
+        char *pending;   ///< Output the terminal has not accepted yet.
+    } output;
+    struct {
+        RYCE_TuiStats frame;  ///< Counters of the frame being rendered, owned by the rendering thread.
+        RYCE_TuiStats last;   ///< Counters of the last written frame, guarded by the lock.
+        pthread_mutex_t lock; ///< Lets other threads read the last counters while the render thread runs.
+    } stats;
+    struct {
+        pthread_t thread_id;                 ///< ID of the render thread.
+        atomic_bool running;                 ///< Whether the render thread is active.
+        atomic_int error;                    ///< Last error reported by the render thread.
+        atomic_uint pending;                 ///< Published frame index, with RYCE_FRAME_FRESH until rendered.
+        uint32_t back;                       ///< Frame index filled by the simulation thread.
+        uint32_t front;                      ///< Frame index drawn by the render thread.
+        struct timespec interval;            ///< Time between rendered frames.
+        RYCE_Frame frames[RYCE_FRAME_COUNT]; ///< Frames handed off to the render thread.
+    } render;
 } RYCE_TuiContext;
 
 typedef struct RYCE_Pane {
     size_t id; //< Pane ID.
+    int32_t z; ///< Stacking order, higher panes cover lower ones. Ties go to the pane created last.
     struct {
         int64_t x;        ///< X coordinate.
         int64_t y;        ///< Y coordinate.
         uint32_t width;   ///< Width.
         uint32_t height;  ///< Height.
     } view;               ///< View rectangle.
+    RYCE_Glyph *glyphs;   ///< Contents of the pane. [width * height]
     RYCE_TuiContext *ctx; ///< Pointer to the TUI context.
+    uint64_t dirty;       ///< Context generation in which the whole pane was marked dirty.
 } RYCE_Pane;
 
 /*
@@ -261,7 +359,9 @@ const RYCE_Glyph RYCE_DEFAULT_GLYPH = {
 */
 
 /**
- * @brief Initializes a pane and fills its buffers with default values.
+ * @brief Initializes a pane, allocates its contents filled with default glyphs and attaches it to the context on
+ * top of the panes with the same z. The pane is referenced by the context and must not move in memory until it is
+ * released with `ryce_free_pane` or `ryce_tui_free_ctx`.
  *
  * @param x X coordinate of the pane.
  * @param y Y coordinate of the pane.
@@ -275,7 +375,38 @@ RYCE_PUBLIC_DECL RYCE_TuiError ryce_init_pane(uint32_t x, uint32_t y, uint32_t w
                                               RYCE_TuiContext *ctx, RYCE_Pane *out);
 
 /**
- * @brief Initializes the Text UI Controller with a pane and a buffer to store changes.
+ * @brief Moves and resizes a pane. Contents in the region shared by both sizes are kept, anchored to the top-left
+ * corner, and whatever the pane no longer covers shows the panes below it again.
+ *
+ * @param pane Pointer to the pane.
+ * @param x New X coordinate of the pane.
+ * @param y New Y coordinate of the pane.
+ * @param width New width of the pane.
+ * @param height New height of the pane.
+ * @return RYCE_TuiError RYCE_TUI_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_TuiError ryce_resize_pane(RYCE_Pane *pane, uint32_t x, uint32_t y, uint32_t width,
+                                                uint32_t height);
+
+/**
+ * @brief Changes the stacking order of a pane. Where panes overlap, the one with the highest z is shown.
+ *
+ * @param pane Pointer to the pane.
+ * @param z New stacking order of the pane.
+ * @return RYCE_TuiError RYCE_TUI_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_TuiError ryce_pane_set_z(RYCE_Pane *pane, int32_t z);
+
+/**
+ * @brief Detaches a pane from its context and frees its contents, the panes below show through where it was.
+ *
+ * @param pane Pointer to the pane.
+ */
+RYCE_PUBLIC_DECL void ryce_free_pane(RYCE_Pane *pane);
+
+/**
+ * @brief Initializes the Text UI Controller with a pane and a buffer to store changes. The buffers are allocated
+ * to fit the width and height, release them with `ryce_tui_free_ctx`.
  *
  * @param width Width of the interface to be rendered.
  * @param height Height of the interface to be rendered.
@@ -285,8 +416,83 @@ RYCE_PUBLIC_DECL RYCE_TuiError ryce_init_pane(uint32_t x, uint32_t y, uint32_t w
 RYCE_PUBLIC_DECL RYCE_TuiError ryce_init_tui_ctx(uint32_t width, uint32_t height, RYCE_TuiContext *out);
 
 /**
- * @brief Renders the TUI and all panes to the terminal.
+ * @brief Reallocates the TUI buffers for a new width and height, typically after a SIGWINCH. Content that fits in
+ * the new dimensions is kept and the entire screen is redrawn on the next render.
+ *
+ * @param tui Pointer to the TUI context.
+ * @param width New width of the interface.
+ * @param height New height of the interface.
+ * @return RYCE_TuiError RYCE_TUI_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_TuiError ryce_resize_tui_ctx(RYCE_TuiContext *tui, uint32_t width, uint32_t height);
+
+/**
+ * @brief Frees the buffers allocated for the TUI context, and the contents of the panes still attached to it.
+ *
+ * @param tui Pointer to the TUI context.
+ */
+RYCE_PUBLIC_DECL void ryce_tui_free_ctx(RYCE_TuiContext *tui);
+
+/**
+ * @brief Redirects rendered output to a sink instead of stdout. Set it before starting the render thread, the
+ * sink is called from that thread while it runs. `ryce_move_cursor` and `ryce_clear_screen` write to the same
+ * output and return RYCE_TUI_ERR_RENDER_THREAD_RUNNING until the thread is stopped.
+ *
+ * @param tui Pointer to the TUI context.
+ * @param sink Function receiving the output, or null to write to stdout again.
+ * @param user Pointer handed to every call of the sink.
+ */
+RYCE_PUBLIC_DECL void ryce_tui_set_sink(RYCE_TuiContext *tui, RYCE_TuiSink sink, void *user);
+
+/**
+ * @brief Lets renders repeat a glyph with REP (CSI n b). Off by default, the Linux console and older
+ * xterm-compatible terminals do not support it. Defining RYCE_TUI_NO_REP keeps it off regardless. Set it before
+ * starting the render thread.
+ *
+ * @param tui Pointer to the TUI context.
+ * @param enabled Whether the terminal supports REP.
+ */
+RYCE_PUBLIC_DECL void ryce_tui_set_rep(RYCE_TuiContext *tui, bool enabled);
+
+/**
+ * @brief Blocks until all output queued for the terminal has been written. Renders skip frames while the queue
+ * is not empty, this waits for it to drain instead.
+ *
+ * @param tui Pointer to the TUI context.
+ * @return RYCE_TuiError RYCE_TUI_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_TuiError ryce_tui_flush(RYCE_TuiContext *tui);
+
+/**
+ * @brief Copies the counters of the last frame written to the output. Safe to call while the render thread runs.
+ *
+ * @param tui Pointer to the TUI context.
+ * @param out Pointer to the stats to fill.
+ */
+RYCE_PUBLIC_DECL void ryce_tui_get_stats(RYCE_TuiContext *tui, RYCE_TuiStats *out);
+
+/**
+ * @brief Starts a thread that renders submitted frames at its own rate. While it runs, `ryce_render_tui` only
+ * publishes the current update buffer and never blocks on terminal output.
+ *
+ * @param tui Pointer to the TUI context.
+ * @param fps Frames rendered per second. Must be greater than 0.
+ * @return RYCE_TuiError RYCE_TUI_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_TuiError ryce_tui_start_render_thread(RYCE_TuiContext *tui, uint32_t fps);
+
+/**
+ * @brief Stops the render thread, drawing the last submitted frame if it was not rendered yet.
+ *
+ * @param tui Pointer to the TUI context.
+ * @return RYCE_TuiError RYCE_TUI_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_TuiError ryce_tui_stop_render_thread(RYCE_TuiContext *tui);
 
+/**
+ * @brief Composites the regions the panes changed, then renders them to the terminal. Only the dirty spans of each
+ * row are visited. If the render thread is running, the frame is submitted to it instead.
+ *
  * @return RYCE_TuiError RYCE_TUI_ERR_NONE if successful, otherwise an error code.
  */
 RYCE_PUBLIC_DECL RYCE_TuiError ryce_render_tui(RYCE_TuiContext *tui);
@@ -314,7 +520,60 @@ RYCE_PUBLIC_DECL RYCE_TuiError ryce_pane_set(RYCE_Pane *pane, uint32_t x, uint32
 RYCE_PUBLIC_DECL RYCE_TuiError ryce_pane_set_str(RYCE_Pane *pane, uint32_t x, uint32_t y, const RYCE_Style *style,
                                                  RYCE_CHAR *ch);
 
-/** * @brief Moves the cursor to a specific position using ANSI escape sequences.
+/**
+ * @brief Copies a rectangle of glyphs into the pane. The rectangle is validated once and copied row by row.
+ *
+ * @param pane Pointer to the pane.
+ * @param x X coordinate of the rectangle in the pane.
+ * @param y Y coordinate of the rectangle in the pane.
+ * @param width Width of the rectangle.
+ * @param height Height of the rectangle.
+ * @param src Pointer to the first glyph of the source rectangle.
+ * @param stride Glyphs between the starts of two source rows.
+ * @return RYCE_TuiError RYCE_TUI_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_TuiError ryce_pane_blit(RYCE_Pane *pane, uint32_t x, uint32_t y, uint32_t width,
+                                              uint32_t height, const RYCE_Glyph *src, size_t stride);
+
+/**
+ * @brief Sets every cell of a rectangle in the pane to the same glyph.
+ *
+ * @param pane Pointer to the pane.
+ * @param x X coordinate of the rectangle in the pane.
+ * @param y Y coordinate of the rectangle in the pane.
+ * @param width Width of the rectangle.
+ * @param height Height of the rectangle.
+ * @param glyph Pointer to the glyph to be set.
+ * @return RYCE_TuiError RYCE_TUI_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_TuiError ryce_pane_fill(RYCE_Pane *pane, uint32_t x, uint32_t y, uint32_t width,
+                                              uint32_t height, const RYCE_Glyph *glyph);
+
+/**
+ * @brief Shifts the contents of a pane by a number of columns and rows. Cells moved in from outside the pane are
+ * reset to the default glyph. The next render scrolls the terminal instead of redrawing the shifted cells when
+ * the pane reaches the right edge of the terminal (horizontal) or spans its full width (vertical). Defining
+ * `RYCE_TUI_DECSLRM` enables left and right margins so any pane can be scrolled on terminals supporting them.
+ *
+ * @param pane Pointer to the pane.
+ * @param dx Columns to move the contents by, positive moves right.
+ * @param dy Rows to move the contents by, positive moves down.
+ * @return RYCE_TuiError RYCE_TUI_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_TuiError ryce_pane_scroll(RYCE_Pane *pane, int32_t dx, int32_t dy);
+
+/**
+ * @brief Marks the whole pane dirty for the next render. Until then, writes to the pane skip comparing cells and
+ * tracking changed columns, so redrawing most of a pane is cheaper after this call. Scrolling does it implicitly.
+ *
+ * @param pane Pointer to the pane.
+ * @return RYCE_TuiError RYCE_TUI_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_TuiError ryce_pane_mark_dirty(RYCE_Pane *pane);
+
+/**
+ * @brief Moves the cursor to a specific position using ANSI escape sequences. Not available while the render
+ * thread runs, see `ryce_tui_set_sink`.
  *
  * @param tui Pointer to the TUI context.
  * @param x X coordinate of the cursor.
@@ -324,12 +583,17 @@ RYCE_PUBLIC_DECL RYCE_TuiError ryce_pane_set_str(RYCE_Pane *pane, uint32_t x, ui
 RYCE_PUBLIC_DECL RYCE_TuiError ryce_move_cursor(RYCE_TuiContext *tui, int64_t x, int64_t y);
 
 /**
- * @brief Performs a `clear` or `cls` using ANSI escape sequences.
+ * @brief Performs a `clear` or `cls` using ANSI escape sequences. The sequence follows any output still queued for
+ * the terminal and is flushed before returning. Not available while the render thread runs, see
+ * `ryce_tui_set_sink`.
+ *
+ * @param tui Pointer to the TUI context.
+ * @return RYCE_TuiError RYCE_TUI_ERR_NONE if successful, otherwise an error code.
  */
-RYCE_PUBLIC_DECL RYCE_TuiError ryce_clear_screen(void);
+RYCE_PUBLIC_DECL RYCE_TuiError ryce_clear_screen(RYCE_TuiContext *tui);
 
 /**
- * @brief Clears the update and cache buffers of a pane.
+ * @brief Resets every cell of the pane to the default glyph. Only the pane's rectangle is visited.
  *
  * @param pane Pane to clear.
  * @return RYCE_TuiError RYCE_TUI_ERR_NONE if successful, otherwise an error code.
@@ -346,22 +610,54 @@ RYCE_PUBLIC_DECL RYCE_TuiError ryce_clear_pane(RYCE_Pane *pane);
   ===========================================================================*/
 #ifdef RYCE_TUI_IMPL
 
-#include <math.h> // log10
+#include <errno.h>  // errno, EINTR, EAGAIN
+#include <fcntl.h>  // open, O_WRONLY, O_NONBLOCK
+#include <poll.h>   // poll, POLLOUT
+#include <stdlib.h> // malloc, calloc, realloc, free
+#include <unistd.h> // write, close, isatty, ttyname, STDOUT_FILENO
 
 #ifndef RYCE_ARRAY_LEN
 #define RYCE_ARRAY_LEN(a) (sizeof(a) / sizeof((a)[0]))
 #endif // RYCE_ARRAY_LEN
 
+// Length of the encoded CSI prefix without the null-terminator.
+#define RYCE_CSI_LEN (sizeof(RYCE_CSI_BYTES) - 1)
+
+// Maximum bytes a single glyph encodes to.
+#define RYCE_UTF8_MAX_LEN 4
+
+// Synchronized output (DEC mode 2026) around each frame, define RYCE_TUI_NO_SYNC_OUTPUT to leave it out.
+#ifndef RYCE_TUI_NO_SYNC_OUTPUT
+#define RYCE_SYNC_BEGIN_BYTES RYCE_CSI_BYTES "?2026h"
+#define RYCE_SYNC_END_BYTES RYCE_CSI_BYTES "?2026l"
+#else
+#define RYCE_SYNC_BEGIN_BYTES ""
+#define RYCE_SYNC_END_BYTES ""
+#endif // RYCE_TUI_NO_SYNC_OUTPUT
+#define RYCE_SYNC_LEN (sizeof(RYCE_SYNC_BEGIN_BYTES) - 1)
+
+// Vectorized glyph diffing, define RYCE_NO_SIMD to force the scalar path.
+#if !defined(RYCE_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+#if defined(__AVX2__)
+#define RYCE_GLYPH_SIMD_AVX2
+#include <immintrin.h>
+#else
+#define RYCE_GLYPH_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+_Static_assert(sizeof(RYCE_Glyph) == 8, "SIMD glyph diffing expects 8-byte glyphs.");
+
+// Bytes of a glyph that carry data (little-endian), padding after a narrow character is ignored.
+#define RYCE_GLYPH_COMPARE_MASK                                                                                        \
+    ((sizeof(RYCE_CHAR) >= 4 ? 0xFFFFFFFFULL : ((1ULL << (8 * sizeof(RYCE_CHAR))) - 1)) |                             \
+     (0xFFFFFFFFULL << (8 * offsetof(RYCE_Glyph, style))))
+#endif
+
 #ifdef RYCE_WIDE_CHAR_SUPPORT
 #include <locale.h> // setlocale, LC_ALL
 #endif
 
-typedef struct RYCE_SkipSequence {
-    bool set;           ///< Flag to indicate if the buffer is set.
-    uint64_t start_idx; ///< Start index of the buffer.
-    uint64_t end_idx;   ///< End index of the buffer.
-} RYCE_SkipSequence;
-
 /**
  * @brief ANSI escape sequences for colors.
  */
@@ -389,310 +685,1605 @@ static const struct {
     {RYCE_STYLE_MODIFIER_HIDDEN, 8, 28}, {RYCE_STYLE_MODIFIER_STRIKETHROUGH, 9, 29},
 };
 
-RYCE_PRIVATE inline size_t ryce_count_digits_internal(const size_t num) {
-    return num == 0 ? 1 : (size_t)log10((double)num) + 1;
+/**
+ * @brief Powers of 10 used to count the digits of an integer, index N holds 10^N.
+ */
+static const uint64_t POWERS_OF_10[] = {
+    1ULL,
+    10ULL,
+    100ULL,
+    1000ULL,
+    10000ULL,
+    100000ULL,
+    1000000ULL,
+    10000000ULL,
+    100000000ULL,
+    1000000000ULL,
+    10000000000ULL,
+    100000000000ULL,
+    1000000000000ULL,
+    10000000000000ULL,
+    100000000000000ULL,
+    1000000000000000ULL,
+    10000000000000000ULL,
+    100000000000000000ULL,
+    1000000000000000000ULL,
+    10000000000000000000ULL,
+};
+
+/**
+ * @brief Two-digit lookup, the pair for N (0-99) starts at index N * 2.
+ */
+static const char DIGIT_PAIRS[] = "00010203040506070809"
+                                  "10111213141516171819"
+                                  "20212223242526272829"
+                                  "30313233343536373839"
+                                  "40414243444546474849"
+                                  "50515253545556575859"
+                                  "60616263646566676869"
+                                  "70717273747576777879"
+                                  "80818283848586878889"
+                                  "90919293949596979899";
+
+RYCE_PRIVATE inline uint32_t ryce_ctz64_internal(const uint64_t bits) {
+    // Index of the lowest set bit, bits must be non-zero.
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctzll(bits);
+#else
+    uint32_t count = 0;
+    while ((bits & (1ULL << count)) == 0) {
+        count++;
+    }
+
+    return count;
+#endif
 }
 
-RYCE_PRIVATE inline void ryce_softreset_controller_internal(RYCE_TuiContext *tui) {
-    tui->write.length = 0;
+RYCE_PRIVATE inline uint32_t ryce_popcount64_internal(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_popcountll(bits);
+#else
+    uint32_t count = 0;
+    for (; bits != 0; bits &= bits - 1) {
+        count++;
+    }
 
-    // Null-terminate the buffers.
-    tui->write.buffer[0] = RYCE_ZERO;
-    tui->ansi_buffer[0] = RYCE_ZERO;
+    return count;
+#endif
 }
 
-RYCE_PRIVATE inline RYCE_TuiError ryce_print_write_buffer_internal(RYCE_TuiContext *tui) {
-    // Null-terminate the write buffer.
-    size_t index = tui->write.length < RYCE_WRITE_BUFFER_CAPACITY ? tui->write.length : RYCE_WRITE_BUFFER_CAPACITY - 1;
-    tui->write.buffer[index] = RYCE_ZERO;
+RYCE_PRIVATE inline uint64_t ryce_now_ns_internal(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+}
+
+RYCE_PRIVATE inline size_t ryce_count_digits_internal(const size_t num) {
+    // Screen coordinates are small, this exits after a few comparisons.
+    size_t digits = 1;
+    while (digits < RYCE_ARRAY_LEN(POWERS_OF_10) && num >= POWERS_OF_10[digits]) {
+        digits++;
+    }
+
+    return digits;
+}
 
-    if (tui->cursor.x == tui->view.width || tui->cursor.y == tui->view.height) {
-        RYCE_PRINTF(RYCE_BUFFER_FMT, tui->write.buffer, (RYCE_SIZE_T)tui->cursor.y, (RYCE_SIZE_T)tui->cursor.x);
+RYCE_PRIVATE inline size_t ryce_write_uint_internal(char *out, size_t num) {
+    const size_t digits = ryce_count_digits_internal(num);
+
+    // Fill from the least significant end, two digits at a time.
+    size_t pos = digits;
+    while (num >= 100) {
+        const size_t pair = (num % 100) * 2;
+        num /= 100;
+        out[--pos] = DIGIT_PAIRS[pair + 1];
+        out[--pos] = DIGIT_PAIRS[pair];
+    }
+
+    if (num >= 10) {
+        out[--pos] = DIGIT_PAIRS[(num * 2) + 1];
+        out[--pos] = DIGIT_PAIRS[num * 2];
     } else {
-        RYCE_PRINTF(RYCE_STR_FMT, tui->write.buffer);
+        out[--pos] = (char)('0' + num);
     }
 
-    if (fflush(stdout) != 0) {
-        return RYCE_TUI_ERR_STDOUT_FLUSH_FAILED;
+    return digits;
+}
+
+RYCE_PRIVATE inline void ryce_mark_dirty_internal(RYCE_TuiContext *tui, const uint32_t x, const uint32_t y,
+                                                  const uint32_t width) {
+    // Grow the row's dirty span to include [x, x + width).
+    if (x < tui->dirty[y].start) {
+        tui->dirty[y].start = x;
     }
 
-    return RYCE_TUI_ERR_NONE;
+    if (x + width > tui->dirty[y].end) {
+        tui->dirty[y].end = x + width;
+    }
+}
+
+RYCE_PRIVATE inline void ryce_clean_span_internal(RYCE_DirtySpan *span) {
+    span->start = UINT32_MAX;
+    span->end = 0;
 }
 
-RYCE_PRIVATE inline RYCE_TuiError ryce_write_style_internal(RYCE_TuiContext *tui, RYCE_Style *new_style) {
-    RYCE_Style old_style = tui->style;
-    bool changed = false;
+RYCE_PRIVATE inline void ryce_merge_span_internal(RYCE_DirtySpan *dst, const RYCE_DirtySpan *src) {
+    dst->start = src->start < dst->start ? src->start : dst->start;
+    dst->end = src->end > dst->end ? src->end : dst->end;
+}
 
-    if (new_style->value == old_style.value) {
-        return RYCE_TUI_ERR_NONE;
+RYCE_PRIVATE inline void ryce_clean_row_internal(RYCE_TuiContext *tui, const uint32_t y) {
+    ryce_clean_span_internal(&tui->dirty[y]);
+}
+
+RYCE_PRIVATE inline void ryce_damage_internal(RYCE_TuiContext *tui, const int64_t x, const int64_t y,
+                                              const uint32_t width) {
+    // Clip [x, x + width) on row y to the view, then grow the row's damaged span.
+    if (y < 0 || y >= tui->view.height) {
+        return;
     }
 
-    // Prefix the ANSI buffer with the CSI sequence.
-    RYCE_SNPRINTF(tui->ansi_buffer, RYCE_ANSI_CODE_BUFFER_SIZE, RYCE_STR_FMT, RYCE_CSI);
+    const int64_t start = x > 0 ? x : 0;
+    const int64_t end = x + width < tui->view.width ? x + width : tui->view.width;
+    if (start < end) {
+        ryce_merge_span_internal(&tui->damage[y], &(RYCE_DirtySpan){.start = (uint32_t)start, .end = (uint32_t)end});
+    }
+}
 
-    // Update the foreground color.
-    if (new_style->part.fg_color != old_style.part.fg_color) {
-        changed = true;
-        RYCE_SNPRINTF(tui->ansi_buffer + RYCE_STRLEN(tui->ansi_buffer),
-                      RYCE_ANSI_CODE_BUFFER_SIZE - RYCE_STRLEN(tui->ansi_buffer), RYCE_LITERAL("%d;"),
-                      COLOR_MAP[new_style->part.fg_color].fg_code);
+RYCE_PRIVATE inline void ryce_damage_rect_internal(RYCE_TuiContext *tui, const int64_t x, const int64_t y,
+                                                   const uint32_t width, const uint32_t height) {
+    for (uint32_t row = 0; row < height; row++) {
+        ryce_damage_internal(tui, x, y + row, width);
     }
+}
 
-    // Update the background color.
-    if (new_style->part.bg_color != old_style.part.bg_color) {
-        changed = true;
-        RYCE_SNPRINTF(tui->ansi_buffer + RYCE_STRLEN(tui->ansi_buffer),
-                      RYCE_ANSI_CODE_BUFFER_SIZE - RYCE_STRLEN(tui->ansi_buffer), RYCE_LITERAL("%d;"),
-                      COLOR_MAP[new_style->part.bg_color].bg_code);
+RYCE_PRIVATE inline void ryce_damage_pane_internal(const RYCE_Pane *pane, const uint32_t x, const uint32_t y,
+                                                   const uint32_t width) {
+    if (pane->dirty == pane->ctx->generation) {
+        // The whole pane is already damaged.
+        return;
     }
 
-    // Update the style flags.
-    uint16_t diff = new_style->part.style_flags ^ old_style.part.style_flags;
-    for (size_t i = 0; i < RYCE_ARRAY_LEN(STYLE_MAP); i++) {
-        if ((diff & STYLE_MAP[i].bit) != 0) {
-            // Determine if the style is on or off.
-            changed = true;
-            bool is_on = (bool)((new_style->part.style_flags & STYLE_MAP[i].bit) != 0);
-            int code = (int)is_on ? STYLE_MAP[i].on_code : STYLE_MAP[i].off_code;
+    ryce_damage_internal(pane->ctx, pane->view.x + x, pane->view.y + y, width);
+}
+
+RYCE_PRIVATE void ryce_composite_internal(RYCE_TuiContext *tui) {
+    for (uint32_t y = 0; y < tui->view.height; y++) {
+        const uint32_t start = tui->damage[y].start;
+        const uint32_t end = tui->damage[y].end;
+        if (start >= end) {
+            // No pane changed on this row.
+            continue;
+        }
+
+        // Start from the topmost pane covering the whole span, the layers below it are hidden.
+        size_t first = 0;
+        bool covered = false;
+        for (size_t i = tui->panes.count; i > 0 && !covered; i--) {
+            const RYCE_Pane *pane = tui->panes.items[i - 1];
+            covered = y >= pane->view.y && y - pane->view.y < pane->view.height && start >= pane->view.x &&
+                      end <= pane->view.x + pane->view.width;
+            first = covered ? i - 1 : 0;
+        }
+
+        RYCE_Glyph *row = &tui->update[(size_t)y * tui->view.width];
+        for (uint32_t x = start; !covered && x < end; x++) {
+            // Cells no pane covers show the default glyph.
+            row[x] = RYCE_DEFAULT_GLYPH;
+        }
+
+        // Paint the span from the bottom to the top.
+        for (size_t i = first; i < tui->panes.count; i++) {
+            const RYCE_Pane *pane = tui->panes.items[i];
+            const int64_t py = (int64_t)y - pane->view.y;
+            const int64_t from = start > pane->view.x ? start : pane->view.x;
+            const int64_t to = end < pane->view.x + pane->view.width ? end : pane->view.x + pane->view.width;
+            if (py < 0 || py >= pane->view.height || from >= to) {
+                continue;
+            }
 
-            // Append the ANSI code to the buffer.
-            RYCE_SNPRINTF(tui->ansi_buffer + RYCE_STRLEN(tui->ansi_buffer),
-                          sizeof(tui->ansi_buffer) - RYCE_STRLEN(tui->ansi_buffer), RYCE_LITERAL("%d;"), code);
+            const RYCE_Glyph *src = &pane->glyphs[((size_t)py * pane->view.width) + (size_t)(from - pane->view.x)];
+            memcpy(&row[from], src, (size_t)(to - from) * sizeof(RYCE_Glyph));
         }
+
+        ryce_mark_dirty_internal(tui, start, y, end - start);
+        ryce_clean_span_internal(&tui->damage[y]);
     }
+}
 
-    if (!changed) {
-        // If nothing changed, just return.
+RYCE_PRIVATE inline RYCE_TuiError ryce_reserve_write_internal(RYCE_TuiContext *tui, const size_t count) {
+    // Always leave room for the null-terminator.
+    if (tui->write.length + count < tui->write.capacity) {
         return RYCE_TUI_ERR_NONE;
     }
 
-    // Replace trailing ';' with 'm'
-    size_t len = RYCE_STRLEN(tui->ansi_buffer);
-    if (len > 0 && tui->ansi_buffer[len - 1] == RYCE_LITERAL(';')) {
-        tui->ansi_buffer[len - 1] = RYCE_LITERAL('m');
-    } else {
-        // In a weird corner case, if the buffer ended exactly, just append 'm'
-        RYCE_SNPRINTF(tui->ansi_buffer + len, RYCE_ANSI_CODE_BUFFER_SIZE - len, RYCE_LITERAL("m"));
+    uint64_t capacity = tui->write.capacity > 0 ? tui->write.capacity : RYCE_ANSI_CODE_BUFFER_SIZE;
+    while (tui->write.length + count >= capacity) {
+        capacity *= 2;
     }
 
-    size_t seq_len = RYCE_STRLEN(tui->ansi_buffer);
-    if (tui->write.length + seq_len >= RYCE_WRITE_BUFFER_CAPACITY) {
-        return RYCE_TUI_ERR_ANSI_BUFFER_OVERFLOW;
+    char *buffer = (char *)realloc(tui->write.buffer, capacity);
+    if (buffer == nullptr) {
+        return RYCE_TUI_ERR_ALLOCATE_BUFFER;
     }
 
-    // Add the ANSI sequence to the write buffer and update the styling.
-    memcpy(tui->write.buffer + tui->write.length, tui->ansi_buffer, seq_len * sizeof(RYCE_CHAR));
-    tui->write.length += seq_len;
+    tui->write.buffer = buffer;
+    tui->write.capacity = capacity;
     return RYCE_TUI_ERR_NONE;
 }
 
-RYCE_PRIVATE inline RYCE_TuiError ryce_write_move_internal(RYCE_TuiContext *tui, const size_t x, const size_t y) {
-    // Write the move sequence to the buffer.
-    RYCE_SNPRINTF(tui->ansi_buffer, sizeof(tui->ansi_buffer) / sizeof(RYCE_CHAR), RYCE_MOVE_ANSI, (RYCE_SIZE_T)y + 1,
-                  (RYCE_SIZE_T)x + 1);
-
-    size_t seq_len = RYCE_STRLEN(tui->ansi_buffer);
-    if (tui->write.length + seq_len >= RYCE_WRITE_BUFFER_CAPACITY) {
-        return RYCE_TUI_ERR_ANSI_BUFFER_OVERFLOW;
+RYCE_PRIVATE inline size_t ryce_encode_utf8_internal(char *out, const RYCE_CHAR ch) {
+#ifdef RYCE_WIDE_CHAR_SUPPORT
+    const uint32_t cp = (uint32_t)ch;
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    } else if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    } else if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
     }
 
-    // Append the move sequence to the write buffer.
-    memcpy(tui->write.buffer + tui->write.length, tui->ansi_buffer, seq_len * sizeof(RYCE_CHAR));
-    tui->write.length += seq_len;
-    return RYCE_TUI_ERR_NONE;
+    out[0] = (char)(0xF0 | ((cp >> 18) & 0x07));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+#else
+    // Narrow characters are written as-is.
+    out[0] = ch;
+    return 1;
+#endif
 }
 
-RYCE_PRIVATE inline RYCE_TuiError ryce_inject_sequence_internal(RYCE_TuiContext *tui, const uint32_t x,
-                                                                const uint32_t y, RYCE_SkipSequence *skip) {
-    if (tui->cursor.y != y) {
-        // Move the cursor to the correct roki.
-        RYCE_TuiError err_code = ryce_write_move_internal(tui, x, y);
-        if (err_code != RYCE_TUI_ERR_NONE) {
-            return err_code;
-        }
-
-        skip->set = false; // Reset the skip sequence.
-        return RYCE_TUI_ERR_NONE;
-    } else if (!skip->set || tui->cursor.x == x) {
-        return RYCE_TUI_ERR_NONE;
-    }
-
-    size_t skipped_length = skip->end_idx - skip->start_idx;
-    size_t expected = ryce_count_digits_internal(x) + ryce_count_digits_internal(y) + RYCE_ANSI_MOVE_COST;
+RYCE_PRIVATE inline void ryce_write_glyph_internal(RYCE_TuiContext *tui, const RYCE_CHAR ch) {
+    // Caller must reserve RYCE_UTF8_MAX_LEN bytes.
+    tui->write.length += ryce_encode_utf8_internal(tui->write.buffer + tui->write.length, ch);
+}
 
-    if (skipped_length && skipped_length < expected) {
-        if (tui->write.length + skipped_length >= RYCE_WRITE_BUFFER_CAPACITY) {
-            // Not enough space in the write buffer.
-            return RYCE_TUI_ERR_WRITE_BUFFER_OVERFLOW;
-        }
+RYCE_PRIVATE inline RYCE_TuiError ryce_write_stdout_internal(const char *buffer, const size_t length) {
+    // Write the bytes directly, retrying on partial writes and interrupts.
+    size_t written = 0;
+    while (written < length) {
+        const ssize_t count = write(STDOUT_FILENO, buffer + written, length - written);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
 
-        // Reprint skipped due to being cheaper than moving cursor.
-        for (size_t i = 0; i < skipped_length; i++) {
-            tui->write.buffer[tui->write.length + i] = tui->update[skip->start_idx + i].ch;
+            return RYCE_TUI_ERR_STDOUT_FLUSH_FAILED;
         }
 
-        tui->write.length += skipped_length;
-    } else {
-        // Move the cursor to the correct position.
-        RYCE_TuiError err_code = ryce_write_move_internal(tui, x, y);
-        if (err_code != RYCE_TUI_ERR_NONE) {
-            return err_code;
-        }
+        written += (size_t)count;
     }
 
-    skip->set = false; // Reset the skip sequence.
     return RYCE_TUI_ERR_NONE;
 }
 
-RYCE_PUBLIC RYCE_TuiError ryce_init_pane(uint32_t x, uint32_t y, const uint32_t width, const uint32_t height,
-                                         RYCE_TuiContext *ctx, RYCE_Pane *out) {
-    if (width == 0 || height == 0) {
-        return RYCE_TUI_ERR_INVALID_DIMENSIONS;
+RYCE_PRIVATE inline int ryce_open_output_internal(void) {
+    // Open the terminal again so only this descriptor is non-blocking, stdin shares stdout's file description.
+    if (!isatty(STDOUT_FILENO)) {
+        return -1;
     }
 
-    out->id = ctx->pane_count++;
-    out->view.x = x;
-    out->view.y = y;
-    out->view.width = width;
-    out->view.height = height;
-    out->ctx = ctx;
-
-    // Initialize the mask to contain the pane's ID.
-    // Initialize the data for the pane to be empty.
-    for (uint32_t row = 0; row < height; row++) {
-        for (uint32_t col = 0; col < width; col++) {
-            // Convert from relative coordinates to absolute coordinates.
-            uint32_t gx = x + col;
-            uint32_t gy = y + row;
+    const char *name = ttyname(STDOUT_FILENO);
+    return name != nullptr ? open(name, O_WRONLY | O_NONBLOCK | O_NOCTTY) : -1;
+}
 
-            if (gx >= ctx->view.width || gy >= ctx->view.height) {
-                // Out of bounds, skip remainder of 'x' glyphs.
+RYCE_PRIVATE inline RYCE_TuiError ryce_drain_output_internal(RYCE_TuiContext *tui) {
+    // Write as much of the queue as the terminal takes without blocking.
+    while (tui->output.offset < tui->output.length) {
+        const ssize_t count =
+            write(tui->output.fd, tui->output.pending + tui->output.offset, tui->output.length - tui->output.offset);
+        if (count < 0) {
+            if (errno == EINTR) {
                 continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return RYCE_TUI_ERR_NONE;
             }
 
-            // Flattened index in the TUI's row-major buffer.
-            size_t idx = (gy * ctx->view.width) + gx;
-
-            // Assign to the pane’s ID.
-            ctx->render_mask[idx] = out->id;
-            ctx->update[idx] = RYCE_DEFAULT_GLYPH;
+            return RYCE_TUI_ERR_STDOUT_FLUSH_FAILED;
         }
+
+        tui->output.offset += (uint64_t)count;
     }
 
+    tui->output.offset = 0;
+    tui->output.length = 0;
     return RYCE_TUI_ERR_NONE;
 }
 
-RYCE_PUBLIC RYCE_TuiError ryce_init_tui_ctx(const uint32_t width, const uint32_t height, RYCE_TuiContext *out) {
-    if (width == 0 || height == 0) {
-        return RYCE_TUI_ERR_INVALID_DIMENSIONS;
-    }
+RYCE_PRIVATE inline RYCE_TuiError ryce_queue_output_internal(RYCE_TuiContext *tui, const char *buffer,
+                                                             const size_t length) {
+    // Queue behind anything still pending so the terminal sees the bytes in order.
+    if (tui->output.length + length > tui->output.capacity) {
+        uint64_t capacity = tui->output.capacity > 0 ? tui->output.capacity : RYCE_ANSI_CODE_BUFFER_SIZE;
+        while (tui->output.length + length > capacity) {
+            capacity *= 2;
+        }
 
-    out->cursor.x = width;
-    out->cursor.y = height;
-    out->view.x = 0;
-    out->view.y = 0;
-    out->view.width = width;
-    out->view.height = height;
-    out->pane_count = 0;
-    out->style = RYCE_DEFAULT_STYLE;
-    out->write.length = 0;
+        char *pending = (char *)realloc(tui->output.pending, capacity);
+        if (pending == nullptr) {
+            return RYCE_TUI_ERR_ALLOCATE_BUFFER;
+        }
 
-    // Initialize the mask and update buffers to contain the default values.
-    for (size_t i = 0; i < RYCE_SCREEN_BUFFER_CAPACITY; i++) {
-        out->render_mask[i] = 0;
-        out->update[i] = RYCE_DEFAULT_GLYPH;
+        tui->output.pending = pending;
+        tui->output.capacity = capacity;
     }
 
-#ifdef RYCE_WIDE_CHAR_SUPPORT
-    setlocale(LC_ALL, "");
-#endif
-#ifdef RYCE_HIDE_CURSOR
-    RYCE_PRINTF(RYCE_HIDE_CURSOR_ANSI);
-#endif
-    return RYCE_TUI_ERR_NONE;
+    memcpy(tui->output.pending + tui->output.length, buffer, length);
+    tui->output.length += length;
+    return ryce_drain_output_internal(tui);
 }
 
-RYCE_PUBLIC RYCE_TuiError ryce_render_tui(RYCE_TuiContext *tui) {
-    // Reset the write and move sequence buffers.
-    ryce_softreset_controller_internal(tui);
-    RYCE_SkipSequence skip = {.set = false, .start_idx = 0, .end_idx = 0};
-    int64_t x = 1;
-    int64_t y = 1;
-    RYCE_TuiError error = RYCE_TUI_ERR_NONE;
+RYCE_PRIVATE inline void ryce_softreset_controller_internal(RYCE_TuiContext *tui) {
+    tui->write.length = 0;
+}
 
-    for (uint32_t i = 0; i < RYCE_SCREEN_BUFFER_CAPACITY; i++) {
-        x = i % tui->view.width; // X position in flattened buffer.
-        y = i / tui->view.width; // Y position in flattened buffer.
+RYCE_PRIVATE inline size_t ryce_append_sgr_internal(char *out, size_t length, const int code) {
+    // All SGR codes in use are one or two digits, emit them directly.
+    if (code >= 10) {
+        out[length++] = (char)('0' + (code / 10));
+    }
 
-        if (x >= tui->view.width || y >= tui->view.height) {
-            // Out of bounds, skip remainder of 'x' glyphs.
-            i = ((y + 1) * tui->view.width) - 1;
-            continue;
-        }
+    out[length++] = (char)('0' + (code % 10));
+    out[length++] = ';';
+    return length;
+}
 
-        const RYCE_Glyph *old_glyph = &tui->cache[i];
-        const RYCE_Glyph *new_glyph = &tui->update[i];
+RYCE_PRIVATE inline size_t ryce_style_codes_internal(char *out, size_t length, const RYCE_Style old_style,
+                                                     const RYCE_Style new_style) {
+    // Update the foreground color.
+    if (new_style.part.fg_color != old_style.part.fg_color) {
+        length = ryce_append_sgr_internal(out, length, COLOR_MAP[new_style.part.fg_color].fg_code);
+    }
 
-        if (new_glyph->ch == old_glyph->ch && new_glyph->style.value == old_glyph->style.value &&
-            new_glyph->style.value == tui->style.value) {
-            // No change, the character is skipable.
-            if (!skip.set) {
-                skip.start_idx = i;
-                skip.end_idx = i + 1;
-                skip.set = true;
-            } else {
-                skip.end_idx++;
-            }
+    // Update the background color.
+    if (new_style.part.bg_color != old_style.part.bg_color) {
+        length = ryce_append_sgr_internal(out, length, COLOR_MAP[new_style.part.bg_color].bg_code);
+    }
 
-            continue;
-        }
+    uint16_t on = new_style.part.style_flags & ~old_style.part.style_flags;
+    uint16_t off = old_style.part.style_flags & ~new_style.part.style_flags;
 
-        // Inject move sequences or reprinted characters.
-        error = ryce_inject_sequence_internal(tui, x, y, &skip);
-        if (error != RYCE_TUI_ERR_NONE) {
-            return error;
-        }
+    // Bold and dim share the same off code, re-enable whichever should stay on.
+    const uint16_t intensity = RYCE_STYLE_MODIFIER_BOLD | RYCE_STYLE_MODIFIER_DIM;
+    if ((off & intensity) != 0) {
+        length = ryce_append_sgr_internal(out, length, STYLE_MAP[0].off_code);
+        on |= new_style.part.style_flags & intensity;
+        off &= ~intensity;
+    }
 
-        // Inject the color code and style sequence if there is a change.
-        error = ryce_write_style_internal(tui, &tui->update[i].style);
-        if (error != RYCE_TUI_ERR_NONE) {
-            return error;
+    // Update the style flags.
+    for (size_t i = 0; i < RYCE_ARRAY_LEN(STYLE_MAP); i++) {
+        if ((off & STYLE_MAP[i].bit) != 0) {
+            length = ryce_append_sgr_internal(out, length, STYLE_MAP[i].off_code);
+        } else if ((on & STYLE_MAP[i].bit) != 0) {
+            length = ryce_append_sgr_internal(out, length, STYLE_MAP[i].on_code);
         }
+    }
 
-        // Check if we're next to the last written character.
-        if (tui->write.length + 1 >= RYCE_WRITE_BUFFER_CAPACITY) {
-            // Exceeded capacity for the write buffer.
-            return RYCE_TUI_ERR_WRITE_BUFFER_OVERFLOW;
-        }
+    return length;
+}
 
-        // Update buffer being written, propagate the change to the back buffer.
-        tui->write.buffer[tui->write.length++] = tui->update[i].ch;
-        tui->cache[i] = tui->update[i];
-        tui->style = tui->update[i].style;
-        tui->cursor.x = x;
-        tui->cursor.y = y;
+RYCE_PRIVATE inline RYCE_TuiError ryce_write_style_internal(RYCE_TuiContext *tui, const RYCE_Style *new_style) {
+    if (new_style->value == tui->style.value) {
+        return RYCE_TUI_ERR_NONE;
     }
 
-    // Render the differences and move the cursor to the bottom of the pane.
-    tui->cursor.x = tui->view.width;
-    tui->cursor.y = tui->view.height;
-    return ryce_print_write_buffer_internal(tui);
-}
+    // Candidate 1: Only toggle what differs from the current style.
+    char *diff = tui->ansi_buffer;
+    size_t diff_len = ryce_style_codes_internal(diff, 0, tui->style, *new_style);
 
-RYCE_PUBLIC RYCE_TuiError ryce_pane_set(RYCE_Pane *pane, uint32_t x, uint32_t y, const RYCE_Glyph *glyph) {
-    if (x >= pane->view.width || y >= pane->view.height) {
-        return RYCE_TUI_ERR_INVALID_COORDINATES;
+    // Candidate 2: Reset everything, then apply the new style from the defaults.
+    char reset[RYCE_ANSI_CODE_BUFFER_SIZE];
+    size_t reset_len = ryce_append_sgr_internal(reset, 0, 0);
+    reset_len = ryce_style_codes_internal(reset, reset_len, RYCE_DEFAULT_STYLE, *new_style);
+
+    const char *codes = diff_len <= reset_len ? diff : reset;
+    const size_t codes_len = diff_len <= reset_len ? diff_len : reset_len;
+    if (codes_len == 0) {
+        // If nothing changed, just return.
+        return RYCE_TUI_ERR_NONE;
     }
 
-    // Convert from relative coordinates to absolute coordinates.
-    size_t idx = ((pane->view.y + y) * pane->ctx->view.width) + (pane->view.x + x);
-    if (idx >= RYCE_SCREEN_BUFFER_CAPACITY) {
-        return RYCE_TUI_ERR_INVALID_COORDINATES;
-    } else if (pane->ctx->render_mask[idx] != pane->id) {
-        return RYCE_TUI_ERR_INVALID_PANE;
+    RYCE_TuiError error = ryce_reserve_write_internal(tui, RYCE_CSI_LEN + codes_len);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
     }
 
-    pane->ctx->update[idx] = *glyph;
+    // Add the ANSI sequence to the write buffer, replacing the trailing ';' with 'm'.
+    char *dst = tui->write.buffer + tui->write.length;
+    memcpy(dst, RYCE_CSI_BYTES, RYCE_CSI_LEN);
+    memcpy(dst + RYCE_CSI_LEN, codes, codes_len);
+    dst[RYCE_CSI_LEN + codes_len - 1] = 'm';
+    tui->write.length += RYCE_CSI_LEN + codes_len;
+    tui->stats.frame.styles++;
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PRIVATE inline RYCE_TuiError ryce_write_move_internal(RYCE_TuiContext *tui, const size_t x, const size_t y) {
+    // CSI, row, ';', column, 'H'.
+    const size_t seq_len = RYCE_CSI_LEN + ryce_count_digits_internal(y + 1) + ryce_count_digits_internal(x + 1) + 2;
+    RYCE_TuiError error = ryce_reserve_write_internal(tui, seq_len);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
+
+    // Write the move sequence directly to the write buffer.
+    char *dst = tui->write.buffer + tui->write.length;
+    memcpy(dst, RYCE_CSI_BYTES, RYCE_CSI_LEN);
+    dst += RYCE_CSI_LEN;
+    dst += ryce_write_uint_internal(dst, y + 1);
+    *dst++ = ';';
+    dst += ryce_write_uint_internal(dst, x + 1);
+    *dst = 'H';
+    tui->write.length += seq_len;
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PRIVATE inline RYCE_TuiError ryce_write_bytes_internal(RYCE_TuiContext *tui, const char *bytes,
+                                                            const size_t length) {
+    RYCE_TuiError error = ryce_reserve_write_internal(tui, length);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
+
+    memcpy(tui->write.buffer + tui->write.length, bytes, length);
+    tui->write.length += length;
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PRIVATE inline RYCE_TuiError ryce_write_csi_internal(RYCE_TuiContext *tui, const size_t first,
+                                                          const size_t second, const char final) {
+    // CSI, first, [';', second], final. Parameters of 0 are omitted, `CSI r` and `CSI 1S` use their defaults.
+    const size_t seq_len = RYCE_CSI_LEN + (first > 1 ? ryce_count_digits_internal(first) : 0) +
+                           (second > 0 ? ryce_count_digits_internal(second) + 1 : 0) + 1;
+    RYCE_TuiError error = ryce_reserve_write_internal(tui, seq_len);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
+
+    char *dst = tui->write.buffer + tui->write.length;
+    memcpy(dst, RYCE_CSI_BYTES, RYCE_CSI_LEN);
+    dst += RYCE_CSI_LEN;
+    if (first > 1) {
+        dst += ryce_write_uint_internal(dst, first);
+    }
+
+    if (second > 0) {
+        *dst++ = ';';
+        dst += ryce_write_uint_internal(dst, second);
+    }
+
+    *dst = final;
+    tui->write.length += seq_len;
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PRIVATE inline void ryce_shift_region_internal(RYCE_Glyph *glyphs, const size_t stride,
+                                                    const RYCE_ScrollRegion *region) {
+    // Walk against the shift direction so every source cell is read before it is overwritten.
+    for (uint32_t row = 0; row < region->height; row++) {
+        const uint32_t y = region->dy > 0 ? region->height - 1 - row : row;
+        for (uint32_t col = 0; col < region->width; col++) {
+            const uint32_t x = region->dx > 0 ? region->width - 1 - col : col;
+            const size_t idx = ((size_t)(region->y + y) * stride) + region->x + x;
+            const int64_t src_x = (int64_t)x - region->dx;
+            const int64_t src_y = (int64_t)y - region->dy;
+            if (src_x < 0 || src_y < 0 || src_x >= region->width || src_y >= region->height) {
+                // Moved in from outside the region.
+                glyphs[idx] = RYCE_DEFAULT_GLYPH;
+                continue;
+            }
+
+            const size_t src_idx = ((size_t)(region->y + src_y) * stride) + region->x + (size_t)src_x;
+            glyphs[idx] = glyphs[src_idx];
+        }
+    }
+}
+
+RYCE_PRIVATE RYCE_TuiError ryce_write_scroll_internal(RYCE_TuiContext *tui, const RYCE_ScrollRegion *scroll) {
+    RYCE_ScrollRegion region = *scroll;
+    if (region.width == 0 || region.height == 0 || region.x + region.width > tui->view.width ||
+        region.y + region.height > tui->view.height) {
+        // Region no longer matches the view.
+        return RYCE_TUI_ERR_NONE;
+    }
+
+#ifndef RYCE_TUI_DECSLRM
+    // Without left and right margins, rows scroll across the full width and characters shift up to the right edge.
+    if (region.x != 0 || region.width != tui->view.width) {
+        region.dy = 0;
+    }
+
+    if (region.x + region.width != tui->view.width) {
+        region.dx = 0;
+    }
+#endif
+
+    if ((uint32_t)abs(region.dx) >= region.width || (uint32_t)abs(region.dy) >= region.height) {
+        // Everything scrolled out, redrawing is as cheap.
+        return RYCE_TUI_ERR_NONE;
+    } else if (region.dx == 0 && region.dy == 0) {
+        return RYCE_TUI_ERR_NONE;
+    }
+
+    // Blank cells take the current background, reset the style so they match the default glyph.
+    RYCE_TuiError error = ryce_write_style_internal(tui, &RYCE_DEFAULT_STYLE);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
+
+    tui->style = RYCE_DEFAULT_STYLE;
+    const bool full_height = region.y == 0 && region.height == tui->view.height;
+#ifdef RYCE_TUI_DECSLRM
+    // Enable left and right margin mode, then confine the scroll to the region's columns.
+    const char margins[] = RYCE_CSI_BYTES "?69h";
+    error = ryce_reserve_write_internal(tui, sizeof(margins) - 1);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
+
+    memcpy(tui->write.buffer + tui->write.length, margins, sizeof(margins) - 1);
+    tui->write.length += sizeof(margins) - 1;
+    error = ryce_write_csi_internal(tui, region.x + 1, region.x + region.width, 's');
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
+
+    // Setting the margins homes the cursor.
+    tui->cursor.x = 0;
+    tui->cursor.y = 0;
+#endif
+
+    if (region.dy != 0) {
+        if (!full_height) {
+            // Confine the scroll to the region's rows.
+            error = ryce_write_csi_internal(tui, region.y + 1, region.y + region.height, 'r');
+            if (error != RYCE_TUI_ERR_NONE) {
+                return error;
+            }
+        }
+
+        // Scroll up (S) moves the contents up, scroll down (T) moves them down.
+        error = ryce_write_csi_internal(tui, (size_t)abs(region.dy), 0, region.dy < 0 ? 'S' : 'T');
+        if (error != RYCE_TUI_ERR_NONE) {
+            return error;
+        }
+
+        if (!full_height) {
+            // Reset the margins, this homes the cursor.
+            error = ryce_write_csi_internal(tui, 0, 0, 'r');
+            if (error != RYCE_TUI_ERR_NONE) {
+                return error;
+            }
+
+            tui->cursor.x = 0;
+            tui->cursor.y = 0;
+        }
+    }
+
+    for (uint32_t y = region.y; region.dx != 0 && y < region.y + region.height; y++) {
+        // Delete (P) characters to move the row left, insert (@) blanks to move it right.
+        error = ryce_write_move_internal(tui, region.x, y);
+        if (error != RYCE_TUI_ERR_NONE) {
+            return error;
+        }
+
+        error = ryce_write_csi_internal(tui, (size_t)abs(region.dx), 0, region.dx < 0 ? 'P' : '@');
+        if (error != RYCE_TUI_ERR_NONE) {
+            return error;
+        }
+
+        tui->cursor.x = region.x;
+        tui->cursor.y = y;
+    }
+
+#ifdef RYCE_TUI_DECSLRM
+    // Disabling the mode drops the left and right margins again.
+    const char reset[] = RYCE_CSI_BYTES "?69l";
+    error = ryce_reserve_write_internal(tui, sizeof(reset) - 1);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
+
+    memcpy(tui->write.buffer + tui->write.length, reset, sizeof(reset) - 1);
+    tui->write.length += sizeof(reset) - 1;
+#endif
+
+    // Mirror the scroll in the cache, the diff then only finds the exposed cells.
+    ryce_shift_region_internal(tui->cache, tui->view.width, &region);
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PRIVATE inline void ryce_merge_scroll_internal(RYCE_ScrollRegion *dst, const RYCE_ScrollRegion *src) {
+    if (src->dx == 0 && src->dy == 0) {
+        return;
+    } else if (dst->dx == 0 && dst->dy == 0) {
+        *dst = *src;
+        return;
+    }
+
+    if (dst->x == src->x && dst->y == src->y && dst->width == src->width && dst->height == src->height) {
+        // Same region, the shifts add up.
+        dst->dx += src->dx;
+        dst->dy += src->dy;
+    } else {
+        // Different regions cannot be expressed as one scroll, fall back to redrawing.
+        *dst = (RYCE_ScrollRegion){0};
+    }
+}
+
+RYCE_PRIVATE inline RYCE_TuiError ryce_print_write_buffer_internal(RYCE_TuiContext *tui) {
+    if (tui->sink.write != nullptr) {
+        return tui->sink.write(tui->sink.user, tui->write.buffer, tui->write.length);
+    } else if (tui->output.fd < 0) {
+        return ryce_write_stdout_internal(tui->write.buffer, tui->write.length);
+    }
+
+    return ryce_queue_output_internal(tui, tui->write.buffer, tui->write.length);
+}
+
+RYCE_PRIVATE RYCE_TuiError ryce_write_control_internal(RYCE_TuiContext *tui, const char *bytes, const size_t length) {
+    // Control sequences outside of a frame take the same path as frames, queued behind anything still pending.
+    ryce_softreset_controller_internal(tui);
+    RYCE_TuiError error = ryce_reserve_write_internal(tui, length);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
+
+    memcpy(tui->write.buffer, bytes, length);
+    tui->write.length = length;
+    return ryce_print_write_buffer_internal(tui);
+}
+
+RYCE_PRIVATE inline size_t ryce_csi_cost_internal(const size_t first, const size_t second) {
+    // Length of the sequence written by ryce_write_csi_internal.
+    return RYCE_CSI_LEN + (first > 1 ? ryce_count_digits_internal(first) : 0) +
+           (second > 0 ? ryce_count_digits_internal(second) + 1 : 0) + 1;
+}
+
+RYCE_PRIVATE inline RYCE_TuiError ryce_write_controls_internal(RYCE_TuiContext *tui, const char control,
+                                                               const size_t count) {
+    // Repeats a single-byte control character (CR, LF, BS).
+    RYCE_TuiError error = ryce_reserve_write_internal(tui, count);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
+
+    memset(tui->write.buffer + tui->write.length, control, count);
+    tui->write.length += count;
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PRIVATE inline size_t ryce_plan_column_internal(const int64_t from, const bool known, const uint32_t x,
+                                                     char *final) {
+    // Cheapest way to reach column x on the current row. An unknown column only allows absolute moves.
+    if (known && from == x) {
+        *final = '\0';
+        return 0;
+    } else if (x == 0) {
+        *final = '\r';
+        return 1;
+    }
+
+    *final = 'G';
+    size_t best = ryce_csi_cost_internal(x + 1, 0);
+    if (!known) {
+        return best;
+    }
+
+    const size_t distance = from < x ? x - (size_t)from : (size_t)from - x;
+    const size_t relative = ryce_csi_cost_internal(distance, 0);
+    if (from > x && distance < best && distance <= relative) {
+        *final = '\b';
+        best = distance;
+    } else if (relative < best) {
+        *final = from < x ? 'C' : 'D';
+        best = relative;
+    }
+
+    return best;
+}
+
+RYCE_PRIVATE inline size_t ryce_plan_row_internal(const int64_t from, const uint32_t y, char *final) {
+    // Cheapest way to reach row y keeping the column.
+    if (from == y) {
+        *final = '\0';
+        return 0;
+    }
+
+    const size_t distance = from < y ? y - (size_t)from : (size_t)from - y;
+    const size_t relative = ryce_csi_cost_internal(distance, 0);
+    const size_t absolute = ryce_csi_cost_internal(y + 1, 0);
+    *final = relative < absolute ? (from < y ? 'B' : 'A') : 'd';
+    return relative < absolute ? relative : absolute;
+}
+
+RYCE_PRIVATE inline RYCE_TuiError ryce_write_plan_internal(RYCE_TuiContext *tui, const char final, const size_t from,
+                                                           const size_t to) {
+    if (final == '\0') {
+        return RYCE_TUI_ERR_NONE;
+    } else if (final == '\r') {
+        return ryce_write_controls_internal(tui, '\r', 1);
+    } else if (final == '\b') {
+        // Only planned for leftward moves, the guard keeps the count from wrapping.
+        return from > to ? ryce_write_controls_internal(tui, '\b', from - to) : RYCE_TUI_ERR_NONE;
+    } else if (final == 'G' || final == 'd') {
+        return ryce_write_csi_internal(tui, to + 1, 0, final);
+    }
+
+    // Relative moves.
+    return ryce_write_csi_internal(tui, from < to ? to - from : from - to, 0, final);
+}
+
+RYCE_PRIVATE inline RYCE_TuiError ryce_position_cursor_internal(RYCE_TuiContext *tui, const RYCE_Glyph *update,
+                                                                const uint32_t x, const uint32_t y) {
+    if (tui->cursor.y == y && tui->cursor.x == x) {
+        // Already in place, continuing from the last written character.
+        return RYCE_TUI_ERR_NONE;
+    }
+
+    // After writing the last column the terminal holds a pending wrap, only absolute column moves are reliable.
+    const bool known = tui->cursor.y < tui->view.height;
+    const bool column_known = known && tui->cursor.x < tui->view.width;
+
+    // Candidate 1: Absolute move (CUP).
+    size_t best = ryce_csi_cost_internal(y + 1, x + 1);
+    enum { PLAN_CUP, PLAN_REPRINT, PLAN_RELATIVE, PLAN_NEWLINE } plan = PLAN_CUP;
+
+    // Candidate 2: Reprint the skipped cells, they must share the current style.
+    const size_t start_idx = ((size_t)y * tui->view.width) + (size_t)tui->cursor.x;
+    if (column_known && tui->cursor.y == y && tui->cursor.x < x) {
+        char encoded[RYCE_UTF8_MAX_LEN];
+        size_t cost = 0;
+        for (size_t i = 0; i < x - (size_t)tui->cursor.x && cost < best; i++) {
+            cost = update[start_idx + i].style.value == tui->style.value
+                       ? cost + ryce_encode_utf8_internal(encoded, update[start_idx + i].ch)
+                       : SIZE_MAX;
+        }
+
+        if (cost < best) {
+            best = cost;
+            plan = PLAN_REPRINT;
+        }
+    }
+
+    // Candidate 3: Move the row (CUU, CUD, VPA) and the column (CR, BS, CUF, CUB, CHA) separately.
+    char row_final = '\0';
+    char column_final = '\0';
+    if (known) {
+        const size_t cost = ryce_plan_row_internal(tui->cursor.y, y, &row_final) +
+                            ryce_plan_column_internal(tui->cursor.x, column_known, x, &column_final);
+        if (cost < best) {
+            best = cost;
+            plan = PLAN_RELATIVE;
+        }
+    }
+
+    // Candidate 4: Carriage return and line feeds, then the column from the start of the row.
+    char newline_final = '\0';
+    if (known && tui->cursor.y < y) {
+        const size_t cost = 1 + (y - (size_t)tui->cursor.y) + ryce_plan_column_internal(0, true, x, &newline_final);
+        if (cost < best) {
+            best = cost;
+            plan = PLAN_NEWLINE;
+        }
+    }
+
+    RYCE_TuiError error = RYCE_TUI_ERR_NONE;
+    switch (plan) {
+    case PLAN_REPRINT:
+        error = ryce_reserve_write_internal(tui, (x - (size_t)tui->cursor.x) * RYCE_UTF8_MAX_LEN);
+        for (size_t i = 0; error == RYCE_TUI_ERR_NONE && i < x - (size_t)tui->cursor.x; i++) {
+            ryce_write_glyph_internal(tui, update[start_idx + i].ch);
+        }
+        break;
+    case PLAN_RELATIVE:
+        error = ryce_write_plan_internal(tui, row_final, (size_t)tui->cursor.y, y);
+        if (error == RYCE_TUI_ERR_NONE) {
+            error = ryce_write_plan_internal(tui, column_final, (size_t)tui->cursor.x, x);
+        }
+        break;
+    case PLAN_NEWLINE:
+        error = ryce_write_controls_internal(tui, '\r', 1);
+        if (error == RYCE_TUI_ERR_NONE) {
+            error = ryce_write_controls_internal(tui, '\n', y - (size_t)tui->cursor.y);
+        }
+
+        if (error == RYCE_TUI_ERR_NONE) {
+            error = ryce_write_plan_internal(tui, newline_final, 0, x);
+        }
+        break;
+    case PLAN_CUP:
+        error = ryce_write_csi_internal(tui, y + 1, x + 1, 'H');
+        break;
+    }
+
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
+
+    if (plan == PLAN_REPRINT) {
+        tui->stats.frame.reprints++;
+    } else {
+        tui->stats.frame.moves++;
+    }
+
+    tui->cursor.x = x;
+    tui->cursor.y = y;
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PRIVATE inline RYCE_TuiError ryce_write_run_internal(RYCE_TuiContext *tui, const RYCE_Glyph *glyph,
+                                                          const uint32_t x, const uint32_t repeat,
+                                                          const bool last) {
+    char encoded[RYCE_UTF8_MAX_LEN];
+    const size_t glyph_len = ryce_encode_utf8_internal(encoded, glyph->ch);
+    const size_t count = (size_t)repeat + 1;
+
+    // Candidate 1: Write every glyph of the run.
+    size_t cost = count * glyph_len;
+    char final = '\0';
+
+#ifndef RYCE_TUI_NO_REP
+    // Candidate 2: Write the glyph once, then repeat (REP) it.
+    const size_t rep_cost = glyph_len + RYCE_CSI_LEN + (repeat > 1 ? ryce_count_digits_internal(repeat) : 0) + 1;
+    if (tui->rep && repeat > 0 && rep_cost < cost) {
+        cost = rep_cost;
+        final = 'b';
+    }
+#endif
+
+    // Candidate 3: Erase (ECH) a run of blanks. The cursor stays put, so only the row's last run qualifies.
+    const size_t ech_cost = RYCE_CSI_LEN + (count > 1 ? ryce_count_digits_internal(count) : 0) + 1;
+    if (last && glyph->ch == RYCE_EMPTY_CHAR && glyph->style.part.fg_color == RYCE_STYLE_COLOR_DEFAULT &&
+        glyph->style.part.style_flags == RYCE_STYLE_MODIFIER_DEFAULT && ech_cost < cost) {
+        tui->cursor.x = x;
+        return ryce_write_csi_internal(tui, count, 0, 'X');
+    }
+
+    RYCE_TuiError error = ryce_reserve_write_internal(tui, final == 'b' ? glyph_len : cost);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
+
+    for (size_t i = 0; i < (final == 'b' ? 1 : count); i++) {
+        memcpy(tui->write.buffer + tui->write.length, encoded, glyph_len);
+        tui->write.length += glyph_len;
+    }
+
+    tui->cursor.x = x + count;
+    return final == 'b' ? ryce_write_csi_internal(tui, repeat, 0, 'b') : RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PRIVATE inline uint32_t ryce_next_changed_internal(const uint64_t *changed, const uint32_t count,
+                                                        uint32_t from) {
+    // Index of the next set bit at or after `from`, or `count` if there is none.
+    while (from < count) {
+        const uint64_t bits = changed[from / 64] >> (from % 64);
+        if (bits != 0) {
+            const uint32_t next = from + ryce_ctz64_internal(bits);
+            return next < count ? next : count;
+        }
+
+        from = ((from / 64) + 1) * 64;
+    }
+
+    return count;
+}
+
+RYCE_PRIVATE inline bool ryce_glyph_changed_internal(const RYCE_Glyph *a, const RYCE_Glyph *b) {
+    return a->ch != b->ch || a->style.value != b->style.value;
+}
+
+RYCE_PRIVATE inline void ryce_diff_row_internal(const RYCE_Glyph *update, const RYCE_Glyph *cache,
+                                                const uint32_t count, uint64_t *changed) {
+    uint32_t i = 0;
+    memset(changed, 0, ((count + 63) / 64) * sizeof(uint64_t));
+
+#if defined(RYCE_GLYPH_SIMD_AVX2)
+    // Four glyphs per compare, padding bytes are masked off.
+    const __m256i keep = _mm256_set1_epi64x((long long)RYCE_GLYPH_COMPARE_MASK);
+    for (; i + 4 <= count; i += 4) {
+        const __m256i a = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(update + i)), keep);
+        const __m256i b = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(cache + i)), keep);
+        const uint64_t equal = (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b)));
+        changed[i / 64] |= (~equal & 0xFULL) << (i % 64);
+    }
+#elif defined(RYCE_GLYPH_SIMD_SSE2)
+    // Two glyphs per compare, a glyph is equal when both of its 32-bit halves are.
+    const __m128i keep = _mm_set1_epi64x((long long)RYCE_GLYPH_COMPARE_MASK);
+    for (; i + 2 <= count; i += 2) {
+        const __m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i *)(update + i)), keep);
+        const __m128i b = _mm_and_si128(_mm_loadu_si128((const __m128i *)(cache + i)), keep);
+        const int equal = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)));
+        const uint64_t bits = (uint64_t)((equal & 0x3) != 0x3) | ((uint64_t)((equal & 0xC) != 0xC) << 1);
+        changed[i / 64] |= bits << (i % 64);
+    }
+#endif
+
+    // Scalar fallback and remainder.
+    for (; i < count; i++) {
+        if (ryce_glyph_changed_internal(&update[i], &cache[i])) {
+            changed[i / 64] |= 1ULL << (i % 64);
+        }
+    }
+}
+
+RYCE_PRIVATE void ryce_sort_panes_internal(RYCE_TuiContext *tui) {
+    // Insertion sort by z then ID, the list is short and nearly sorted.
+    for (size_t i = 1; i < tui->panes.count; i++) {
+        RYCE_Pane *pane = tui->panes.items[i];
+        size_t j = i;
+        while (j > 0 && (tui->panes.items[j - 1]->z > pane->z ||
+                         (tui->panes.items[j - 1]->z == pane->z && tui->panes.items[j - 1]->id > pane->id))) {
+            tui->panes.items[j] = tui->panes.items[j - 1];
+            j--;
+        }
+
+        tui->panes.items[j] = pane;
+    }
+}
+
+RYCE_PUBLIC RYCE_TuiError ryce_init_pane(uint32_t x, uint32_t y, const uint32_t width, const uint32_t height,
+                                         RYCE_TuiContext *ctx, RYCE_Pane *out) {
+    if (width == 0 || height == 0) {
+        return RYCE_TUI_ERR_INVALID_DIMENSIONS;
+    }
+
+    if (ctx->panes.count == ctx->panes.capacity) {
+        const size_t capacity = ctx->panes.capacity > 0 ? ctx->panes.capacity * 2 : 4;
+        RYCE_Pane **items = (RYCE_Pane **)realloc(ctx->panes.items, capacity * sizeof(RYCE_Pane *));
+        if (!items) {
+            return RYCE_TUI_ERR_ALLOCATE_BUFFER;
+        }
+
+        ctx->panes.items = items;
+        ctx->panes.capacity = capacity;
+    }
+
+    const size_t cells = (size_t)width * height;
+    RYCE_Glyph *glyphs = (RYCE_Glyph *)malloc(cells * sizeof(RYCE_Glyph));
+    if (!glyphs) {
+        return RYCE_TUI_ERR_ALLOCATE_BUFFER;
+    }
+
+    // Initialize the data for the pane to be empty.
+    for (size_t i = 0; i < cells; i++) {
+        glyphs[i] = RYCE_DEFAULT_GLYPH;
+    }
+
+    *out = (RYCE_Pane){
+        .id = ctx->pane_count++,
+        .z = 0,
+        .view = {.x = x, .y = y, .width = width, .height = height},
+        .glyphs = glyphs,
+        .ctx = ctx,
+        .dirty = 0,
+    };
+
+    // Attach on top of the panes sharing its z.
+    ctx->panes.items[ctx->panes.count++] = out;
+    ryce_sort_panes_internal(ctx);
+    ryce_damage_rect_internal(ctx, x, y, width, height);
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PUBLIC RYCE_TuiError ryce_resize_pane(RYCE_Pane *pane, const uint32_t x, const uint32_t y, const uint32_t width,
+                                           const uint32_t height) {
+    if (width == 0 || height == 0) {
+        return RYCE_TUI_ERR_INVALID_DIMENSIONS;
+    }
+
+    RYCE_Glyph *glyphs = (RYCE_Glyph *)malloc((size_t)width * height * sizeof(RYCE_Glyph));
+    if (!glyphs) {
+        return RYCE_TUI_ERR_ALLOCATE_BUFFER;
+    }
+
+    // Keep the content of the region shared by both sizes.
+    for (uint32_t row = 0; row < height; row++) {
+        for (uint32_t col = 0; col < width; col++) {
+            const bool kept = col < pane->view.width && row < pane->view.height;
+            glyphs[((size_t)row * width) + col] =
+                kept ? pane->glyphs[((size_t)row * pane->view.width) + col] : RYCE_DEFAULT_GLYPH;
+        }
+    }
+
+    // Both the old and the new rectangle have to be composited again.
+    ryce_damage_rect_internal(pane->ctx, pane->view.x, pane->view.y, pane->view.width, pane->view.height);
+    ryce_damage_rect_internal(pane->ctx, x, y, width, height);
+    free(pane->glyphs);
+    pane->glyphs = glyphs;
+    pane->view.x = x;
+    pane->view.y = y;
+    pane->view.width = width;
+    pane->view.height = height;
+    pane->dirty = 0;
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PUBLIC RYCE_TuiError ryce_pane_set_z(RYCE_Pane *pane, const int32_t z) {
+    if (pane->z == z) {
+        return RYCE_TUI_ERR_NONE;
+    }
+
+    pane->z = z;
+    ryce_sort_panes_internal(pane->ctx);
+    ryce_damage_rect_internal(pane->ctx, pane->view.x, pane->view.y, pane->view.width, pane->view.height);
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PUBLIC void ryce_free_pane(RYCE_Pane *pane) {
+    RYCE_TuiContext *ctx = pane->ctx;
+    if (ctx != nullptr) {
+        // Detach the pane and uncover what is below it.
+        size_t i = 0;
+        while (i < ctx->panes.count && ctx->panes.items[i] != pane) {
+            i++;
+        }
+
+        if (i < ctx->panes.count) {
+            memmove(&ctx->panes.items[i], &ctx->panes.items[i + 1], (ctx->panes.count - i - 1) * sizeof(RYCE_Pane *));
+            ctx->panes.count--;
+        }
+
+        ryce_damage_rect_internal(ctx, pane->view.x, pane->view.y, pane->view.width, pane->view.height);
+    }
+
+    free(pane->glyphs);
+    pane->glyphs = nullptr;
+    pane->ctx = nullptr;
+}
+
+RYCE_PUBLIC RYCE_TuiError ryce_init_tui_ctx(const uint32_t width, const uint32_t height, RYCE_TuiContext *out) {
+    if (width == 0 || height == 0) {
+        return RYCE_TUI_ERR_INVALID_DIMENSIONS;
+    }
+
+    *out = (RYCE_TuiContext){
+        .view = {.x = 0, .y = 0, .width = width, .height = height},
+        .cursor = {.x = width, .y = height},
+        .style = RYCE_DEFAULT_STYLE,
+        .pane_count = 0,
+        .output = {.fd = -1},
+        .generation = 1,
+    };
+
+    if (pthread_mutex_init(&out->stats.lock, nullptr) != 0) {
+        return RYCE_TUI_ERR_INVALID_TUI;
+    }
+
+    const size_t cells = (size_t)width * height;
+    out->write.capacity = (cells * RYCE_WRITE_BUFFER_SCALE) + 1;
+    out->write.buffer = (char *)malloc(out->write.capacity);
+    out->dirty = (RYCE_DirtySpan *)malloc(height * sizeof(RYCE_DirtySpan));
+    out->update = (RYCE_Glyph *)malloc(cells * sizeof(RYCE_Glyph));
+    out->cache = (RYCE_Glyph *)calloc(cells, sizeof(RYCE_Glyph));
+    out->damage = (RYCE_DirtySpan *)malloc(height * sizeof(RYCE_DirtySpan));
+    out->changed = (uint64_t *)malloc(((width + 63) / 64) * sizeof(uint64_t));
+    if (!out->write.buffer || !out->dirty || !out->update || !out->cache || !out->damage || !out->changed) {
+        ryce_tui_free_ctx(out);
+        return RYCE_TUI_ERR_ALLOCATE_BUFFER;
+    }
+
+    // Initialize the update buffer to contain the default values.
+    for (size_t i = 0; i < cells; i++) {
+        out->update[i] = RYCE_DEFAULT_GLYPH;
+    }
+
+    // Nothing has been rendered yet, every row must be drawn.
+    for (uint32_t y = 0; y < height; y++) {
+        ryce_clean_row_internal(out, y);
+        ryce_clean_span_internal(&out->damage[y]);
+        ryce_mark_dirty_internal(out, 0, y, width);
+    }
+
+#ifdef RYCE_WIDE_CHAR_SUPPORT
+    setlocale(LC_ALL, "");
+#endif
+    out->output.fd = ryce_open_output_internal();
+#ifdef RYCE_HIDE_CURSOR
+    const char hide_cursor[] = RYCE_CSI_BYTES "?25l";
+    ryce_write_control_internal(out, hide_cursor, sizeof(hide_cursor) - 1);
+#endif
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PUBLIC RYCE_TuiError ryce_resize_tui_ctx(RYCE_TuiContext *tui, const uint32_t width, const uint32_t height) {
+    if (width == 0 || height == 0) {
+        return RYCE_TUI_ERR_INVALID_DIMENSIONS;
+    }
+
+    // Frames are sized to the view, restart the render thread around the resize.
+    const bool threaded = atomic_load(&tui->render.running);
+    const struct timespec interval = tui->render.interval;
+    if (threaded) {
+        ryce_tui_stop_render_thread(tui);
+    }
+
+    const size_t cells = (size_t)width * height;
+    RYCE_DirtySpan *dirty = (RYCE_DirtySpan *)malloc(height * sizeof(RYCE_DirtySpan));
+    RYCE_Glyph *update = (RYCE_Glyph *)malloc(cells * sizeof(RYCE_Glyph));
+    RYCE_Glyph *cache = (RYCE_Glyph *)calloc(cells, sizeof(RYCE_Glyph));
+    RYCE_DirtySpan *damage = (RYCE_DirtySpan *)malloc(height * sizeof(RYCE_DirtySpan));
+    uint64_t *changed = (uint64_t *)malloc(((width + 63) / 64) * sizeof(uint64_t));
+    if (!dirty || !update || !cache || !damage || !changed) {
+        free(dirty);
+        free(update);
+        free(cache);
+        free(damage);
+        free(changed);
+        return RYCE_TUI_ERR_ALLOCATE_BUFFER;
+    }
+
+    free(tui->dirty);
+    free(tui->update);
+    free(tui->cache);
+    free(tui->damage);
+    free(tui->changed);
+    tui->dirty = dirty;
+    tui->update = update;
+    tui->cache = cache;
+    tui->damage = damage;
+    tui->changed = changed;
+    tui->view.width = width;
+    tui->view.height = height;
+
+    // The terminal contents are unknown after a resize, clear and redraw everything.
+    tui->clear = true;
+    tui->scroll = (RYCE_ScrollRegion){0};
+    tui->generation++;
+    tui->cursor.x = width;
+    tui->cursor.y = height;
+    for (uint32_t y = 0; y < height; y++) {
+        ryce_clean_row_internal(tui, y);
+        ryce_mark_dirty_internal(tui, 0, y, width);
+        ryce_clean_span_internal(&tui->damage[y]);
+        ryce_damage_internal(tui, 0, y, width);
+    }
+
+    RYCE_TuiError error = ryce_reserve_write_internal(tui, cells * RYCE_WRITE_BUFFER_SCALE);
+    if (error == RYCE_TUI_ERR_NONE && threaded) {
+        const uint32_t fps = (uint32_t)(1000000000L / ((interval.tv_sec * 1000000000L) + interval.tv_nsec));
+        error = ryce_tui_start_render_thread(tui, fps > 0 ? fps : 1);
+    }
+
+    return error;
+}
+
+RYCE_PUBLIC void ryce_tui_free_ctx(RYCE_TuiContext *tui) {
+    ryce_tui_stop_render_thread(tui);
+    ryce_tui_flush(tui);
+    if (tui->output.fd >= 0) {
+        close(tui->output.fd);
+    }
+
+    free(tui->output.pending);
+    pthread_mutex_destroy(&tui->stats.lock);
+    tui->output.fd = -1;
+    tui->output.pending = nullptr;
+    tui->output.capacity = 0;
+    tui->output.length = 0;
+    tui->output.offset = 0;
+    free(tui->write.buffer);
+    free(tui->dirty);
+    free(tui->update);
+    free(tui->cache);
+    free(tui->damage);
+    free(tui->changed);
+    tui->write.buffer = nullptr;
+    tui->write.capacity = 0;
+    tui->write.length = 0;
+    tui->dirty = nullptr;
+    tui->update = nullptr;
+    tui->cache = nullptr;
+    tui->damage = nullptr;
+    tui->changed = nullptr;
+
+    // Release the panes still attached.
+    for (size_t i = 0; i < tui->panes.count; i++) {
+        free(tui->panes.items[i]->glyphs);
+        tui->panes.items[i]->glyphs = nullptr;
+        tui->panes.items[i]->ctx = nullptr;
+    }
+
+    free(tui->panes.items);
+    tui->panes.items = nullptr;
+    tui->panes.count = 0;
+    tui->panes.capacity = 0;
+}
+
+RYCE_PUBLIC void ryce_tui_set_sink(RYCE_TuiContext *tui, RYCE_TuiSink sink, void *user) {
+    tui->sink.write = sink;
+    tui->sink.user = user;
+}
+
+RYCE_PUBLIC void ryce_tui_set_rep(RYCE_TuiContext *tui, const bool enabled) {
+    tui->rep = enabled;
+}
+
+RYCE_PUBLIC void ryce_tui_get_stats(RYCE_TuiContext *tui, RYCE_TuiStats *out) {
+    pthread_mutex_lock(&tui->stats.lock);
+    *out = tui->stats.last;
+    pthread_mutex_unlock(&tui->stats.lock);
+}
+
+RYCE_PRIVATE void ryce_publish_stats_internal(RYCE_TuiContext *tui) {
+    pthread_mutex_lock(&tui->stats.lock);
+    tui->stats.last = tui->stats.frame;
+    pthread_mutex_unlock(&tui->stats.lock);
+}
+
+RYCE_PRIVATE void ryce_skip_frame_internal(RYCE_TuiContext *tui) {
+    pthread_mutex_lock(&tui->stats.lock);
+    tui->stats.frame.skipped++;
+    tui->stats.last.skipped = tui->stats.frame.skipped;
+    pthread_mutex_unlock(&tui->stats.lock);
+}
+
+RYCE_PUBLIC RYCE_TuiError ryce_tui_flush(RYCE_TuiContext *tui) {
+    while (tui->output.length > 0) {
+        RYCE_TuiError error = ryce_drain_output_internal(tui);
+        if (error != RYCE_TUI_ERR_NONE) {
+            return error;
+        }
+
+        // Wait for the terminal to accept more.
+        struct pollfd fds = {.fd = tui->output.fd, .events = POLLOUT};
+        if (tui->output.length > 0 && poll(&fds, 1, -1) < 0 && errno != EINTR) {
+            return RYCE_TUI_ERR_STDOUT_FLUSH_FAILED;
+        }
+    }
+
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PRIVATE RYCE_TuiError ryce_render_frame_internal(RYCE_TuiContext *tui, const RYCE_Glyph *update,
+                                                      const RYCE_DirtySpan *dirty, const RYCE_ScrollRegion *scroll) {
+    // Reset the write and move sequence buffers, and the counters of the previous frame.
+    ryce_softreset_controller_internal(tui);
+    const uint64_t started = ryce_now_ns_internal();
+    tui->stats.frame = (RYCE_TuiStats){.frames = tui->stats.frame.frames, .skipped = tui->stats.frame.skipped};
+    RYCE_TuiError error = ryce_write_bytes_internal(tui, RYCE_SYNC_BEGIN_BYTES, RYCE_SYNC_LEN);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
+
+    if (tui->clear) {
+        // Terminal contents are unknown, wipe them before redrawing.
+        const char clear[] = RYCE_CSI_BYTES "2J";
+        error = ryce_reserve_write_internal(tui, sizeof(clear) - 1);
+        if (error != RYCE_TUI_ERR_NONE) {
+            return error;
+        }
+
+        memcpy(tui->write.buffer + tui->write.length, clear, sizeof(clear) - 1);
+        tui->write.length += sizeof(clear) - 1;
+        tui->clear = false;
+    } else if (scroll->dx != 0 || scroll->dy != 0) {
+        // Shift what is already on the terminal instead of redrawing it.
+        error = ryce_write_scroll_internal(tui, scroll);
+        if (error != RYCE_TUI_ERR_NONE) {
+            return error;
+        }
+    }
+
+    for (uint32_t y = 0; y < tui->view.height; y++) {
+        const uint32_t start = dirty[y].start;
+        const uint32_t end = dirty[y].end < tui->view.width ? dirty[y].end : tui->view.width;
+        if (start >= end) {
+            // Row has not been touched since the last render.
+            continue;
+        }
+
+        // Pre-pass, find every changed cell in the dirty span.
+        const size_t row_idx = ((size_t)y * tui->view.width) + start;
+        const uint32_t count = end - start;
+        ryce_diff_row_internal(&update[row_idx], &tui->cache[row_idx], count, tui->changed);
+        for (uint32_t k = 0; k < (count + 63) / 64; k++) {
+            tui->stats.frame.cells += ryce_popcount64_internal(tui->changed[k]);
+        }
+
+        uint32_t col = ryce_next_changed_internal(tui->changed, count, 0);
+        while (col < count) {
+            const uint32_t x = start + col;
+            const size_t i = ((size_t)y * tui->view.width) + x;
+            const RYCE_Glyph *new_glyph = &update[i];
+
+            // Extend the run of identical glyphs up to its last changed cell.
+            uint32_t repeat = 0;
+            for (uint32_t k = col + 1; k < count; k++) {
+                if (ryce_glyph_changed_internal(&update[i + k - col], new_glyph)) {
+                    break;
+                } else if ((tui->changed[k / 64] & (1ULL << (k % 64))) != 0) {
+                    repeat = k - col;
+                }
+            }
+
+            const uint32_t next = ryce_next_changed_internal(tui->changed, count, col + repeat + 1);
+
+            // Inject move sequences or reprinted characters.
+            error = ryce_position_cursor_internal(tui, update, x, y);
+            if (error != RYCE_TUI_ERR_NONE) {
+                return error;
+            }
+
+            // Inject the color code and style sequence if there is a change.
+            error = ryce_write_style_internal(tui, &new_glyph->style);
+            if (error != RYCE_TUI_ERR_NONE) {
+                return error;
+            }
+
+            // Update buffer being written, propagate the change to the back buffer.
+            error = ryce_write_run_internal(tui, new_glyph, x, repeat, next >= count);
+            if (error != RYCE_TUI_ERR_NONE) {
+                return error;
+            }
+
+            for (uint32_t k = 0; k <= repeat; k++) {
+                tui->cache[i + k] = *new_glyph;
+            }
+
+            tui->style = new_glyph->style;
+            tui->cursor.y = y;
+            col = next;
+        }
+    }
+
+    // Move the cursor to the bottom-right of the view.
+    const uint32_t park_x = tui->view.width - 1;
+    const uint32_t park_y = tui->view.height - 1;
+    error = ryce_position_cursor_internal(tui, update, park_x, park_y);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
+
+    if (tui->write.length == RYCE_SYNC_LEN) {
+        // Nothing changed, skip the write. The idle frame still replaces the last frame's counters.
+        tui->stats.frame = (RYCE_TuiStats){.frames = tui->stats.frame.frames, .skipped = tui->stats.frame.skipped};
+        ryce_publish_stats_internal(tui);
+        return RYCE_TUI_ERR_NONE;
+    }
+
+    // Close the synchronized update, the terminal presents the frame at once.
+    error = ryce_write_bytes_internal(tui, RYCE_SYNC_END_BYTES, RYCE_SYNC_LEN);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
+
+    const uint64_t encoded = ryce_now_ns_internal();
+    error = ryce_print_write_buffer_internal(tui);
+    if (error != RYCE_TUI_ERR_NONE) {
+        // Only frames that reached the output are counted.
+        return error;
+    }
+
+    tui->stats.frame.frames++;
+    tui->stats.frame.bytes = tui->write.length;
+    tui->stats.frame.diff_ns = encoded - started;
+    tui->stats.frame.flush_ns = ryce_now_ns_internal() - encoded;
+    ryce_publish_stats_internal(tui);
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PRIVATE RYCE_TuiError ryce_submit_frame_internal(RYCE_TuiContext *tui) {
+    const size_t cells = (size_t)tui->view.width * tui->view.height;
+    RYCE_Frame *frame = &tui->render.frames[tui->render.back];
+
+    // Snapshot the update buffer and hand the dirty rows over to the frame.
+    memcpy(frame->glyphs, tui->update, cells * sizeof(RYCE_Glyph));
+    for (uint32_t y = 0; y < tui->view.height; y++) {
+        frame->dirty[y] = tui->dirty[y];
+        ryce_clean_row_internal(tui, y);
+    }
+
+    const RYCE_ScrollRegion submitted = tui->scroll;
+    tui->scroll = (RYCE_ScrollRegion){0};
+
+    // Publish the frame, taking back the previously published one.
+    uint32_t previous = atomic_load(&tui->render.pending);
+    do {
+        frame->scroll = submitted;
+        if ((previous & RYCE_FRAME_FRESH) != 0) {
+            // Published frame is about to be dropped, carry its dirty rows. Published frames are read-only.
+            const RYCE_Frame *dropped = &tui->render.frames[previous & ~RYCE_FRAME_FRESH];
+            for (uint32_t y = 0; y < tui->view.height; y++) {
+                ryce_merge_span_internal(&frame->dirty[y], &dropped->dirty[y]);
+            }
+
+            // The dropped scroll happens first, then this frame's.
+            frame->scroll = dropped->scroll;
+            ryce_merge_scroll_internal(&frame->scroll, &submitted);
+        }
+    } while (!atomic_compare_exchange_weak(&tui->render.pending, &previous, tui->render.back | RYCE_FRAME_FRESH));
+
+    tui->render.back = previous & ~RYCE_FRAME_FRESH;
+    return (RYCE_TuiError)atomic_load(&tui->render.error);
+}
+
+RYCE_PRIVATE RYCE_TuiError ryce_render_pending_internal(RYCE_TuiContext *tui) {
+    if ((atomic_load(&tui->render.pending) & RYCE_FRAME_FRESH) == 0) {
+        // Nothing new was submitted.
+        return RYCE_TUI_ERR_NONE;
+    }
+
+    RYCE_TuiError error = ryce_drain_output_internal(tui);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    } else if (tui->output.length > 0) {
+        // Leave the frame published while the terminal is behind, newer submissions replace it.
+        ryce_skip_frame_internal(tui);
+        return RYCE_TUI_ERR_NONE;
+    }
+
+    // Swap the published frame in, handing the old front frame back.
+    const uint32_t previous = atomic_exchange(&tui->render.pending, tui->render.front);
+    tui->render.front = previous & ~RYCE_FRAME_FRESH;
+
+    RYCE_Frame *frame = &tui->render.frames[tui->render.front];
+    return ryce_render_frame_internal(tui, frame->glyphs, frame->dirty, &frame->scroll);
+}
+
+RYCE_PRIVATE void *ryce_render_thread_internal(void *arg) {
+    RYCE_TuiContext *tui = (RYCE_TuiContext *)arg;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (atomic_load(&tui->render.running)) {
+        RYCE_TuiError error = ryce_render_pending_internal(tui);
+        if (error != RYCE_TUI_ERR_NONE) {
+            atomic_store(&tui->render.error, (int)error);
+        }
+
+        // Sleep until the next frame is due, resyncing if rendering fell behind.
+        next.tv_sec += tui->render.interval.tv_sec;
+        next.tv_nsec += tui->render.interval.tv_nsec;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_sec += 1;
+            next.tv_nsec -= 1000000000L;
+        }
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        struct timespec req = {.tv_sec = next.tv_sec - now.tv_sec, .tv_nsec = next.tv_nsec - now.tv_nsec};
+        if (req.tv_nsec < 0) {
+            req.tv_sec -= 1;
+            req.tv_nsec += 1000000000L;
+        }
+
+        if (req.tv_sec < 0) {
+            next = now;
+            continue;
+        }
+
+        struct timespec rem;
+        while (nanosleep(&req, &rem) == -1 && errno == EINTR) {
+            req = rem; // Continue sleeping for the remaining time.
+        }
+    }
+
+    return nullptr;
+}
+
+RYCE_PRIVATE void ryce_free_frames_internal(RYCE_TuiContext *tui) {
+    for (size_t i = 0; i < RYCE_FRAME_COUNT; i++) {
+        free(tui->render.frames[i].glyphs);
+        free(tui->render.frames[i].dirty);
+        tui->render.frames[i].glyphs = nullptr;
+        tui->render.frames[i].dirty = nullptr;
+    }
+}
+
+RYCE_PUBLIC RYCE_TuiError ryce_tui_start_render_thread(RYCE_TuiContext *tui, const uint32_t fps) {
+    if (fps == 0) {
+        return RYCE_TUI_ERR_INVALID_DIMENSIONS;
+    } else if (atomic_load(&tui->render.running)) {
+        return RYCE_TUI_ERR_NONE;
+    }
+
+    const size_t cells = (size_t)tui->view.width * tui->view.height;
+    for (size_t i = 0; i < RYCE_FRAME_COUNT; i++) {
+        RYCE_Frame *frame = &tui->render.frames[i];
+        frame->glyphs = (RYCE_Glyph *)malloc(cells * sizeof(RYCE_Glyph));
+        frame->dirty = (RYCE_DirtySpan *)malloc(tui->view.height * sizeof(RYCE_DirtySpan));
+        if (!frame->glyphs || !frame->dirty) {
+            ryce_free_frames_internal(tui);
+            return RYCE_TUI_ERR_ALLOCATE_BUFFER;
+        }
+
+        for (uint32_t y = 0; y < tui->view.height; y++) {
+            ryce_clean_span_internal(&frame->dirty[y]);
+        }
+    }
+
+    tui->render.back = 0;
+    tui->render.front = 1;
+    tui->render.interval = (struct timespec){.tv_sec = 0, .tv_nsec = 1000000000L / fps};
+    if (fps == 1) {
+        tui->render.interval = (struct timespec){.tv_sec = 1, .tv_nsec = 0};
+    }
+
+    atomic_store(&tui->render.pending, 2);
+    atomic_store(&tui->render.error, (int)RYCE_TUI_ERR_NONE);
+    atomic_store(&tui->render.running, true);
+    if (pthread_create(&tui->render.thread_id, nullptr, ryce_render_thread_internal, tui) != 0) {
+        atomic_store(&tui->render.running, false);
+        ryce_free_frames_internal(tui);
+        return RYCE_TUI_ERR_INVALID_TUI;
+    }
+
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PUBLIC RYCE_TuiError ryce_tui_stop_render_thread(RYCE_TuiContext *tui) {
+    if (!atomic_load(&tui->render.running)) {
+        return RYCE_TUI_ERR_NONE;
+    }
+
+    atomic_store(&tui->render.running, false);
+    pthread_join(tui->render.thread_id, nullptr);
+
+    // Draw whatever was submitted last so the terminal matches the cache.
+    RYCE_TuiError error = ryce_tui_flush(tui);
+    if (error == RYCE_TUI_ERR_NONE) {
+        error = ryce_render_pending_internal(tui);
+    }
+
+    ryce_free_frames_internal(tui);
+    return error;
+}
+
+RYCE_PUBLIC RYCE_TuiError ryce_render_tui(RYCE_TuiContext *tui) {
+    // Merge what the panes changed, then consume the dirty spans. Panes marked fully dirty go back to tracking writes.
+    ryce_composite_internal(tui);
+    tui->generation++;
+    if (atomic_load(&tui->render.running)) {
+        return ryce_submit_frame_internal(tui);
+    }
+
+    RYCE_TuiError error = ryce_drain_output_internal(tui);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    } else if (tui->output.length > 0) {
+        // The terminal is behind, drop this frame. Dirty rows carry over so the next render diffs to the newest state.
+        ryce_skip_frame_internal(tui);
+        return RYCE_TUI_ERR_NONE;
+    }
+
+    error = ryce_render_frame_internal(tui, tui->update, tui->dirty, &tui->scroll);
+    tui->scroll = (RYCE_ScrollRegion){0};
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
+
+    // Every row is now in sync with the terminal.
+    for (uint32_t y = 0; y < tui->view.height; y++) {
+        ryce_clean_row_internal(tui, y);
+    }
+
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PUBLIC RYCE_TuiError ryce_pane_set(RYCE_Pane *pane, uint32_t x, uint32_t y, const RYCE_Glyph *glyph) {
+    if (x >= pane->view.width || y >= pane->view.height) {
+        return RYCE_TUI_ERR_INVALID_COORDINATES;
+    }
+
+    RYCE_Glyph *current = &pane->glyphs[((size_t)y * pane->view.width) + x];
+    if (current->ch == glyph->ch && current->style.value == glyph->style.value) {
+        // Unchanged, avoid damaging the row.
+        return RYCE_TUI_ERR_NONE;
+    }
+
+    *current = *glyph;
+    ryce_damage_pane_internal(pane, x, y, 1);
     return RYCE_TUI_ERR_NONE;
 }
 
@@ -716,59 +2307,178 @@ RYCE_PUBLIC RYCE_TuiError ryce_pane_set_str(RYCE_Pane *pane, uint32_t x, uint32_
     return RYCE_TUI_ERR_NONE;
 }
 
-RYCE_PUBLIC_DECL RYCE_TuiError ryce_move_cursor(RYCE_TuiContext *tui, int64_t x, int64_t y) {
-    if (x == tui->cursor.x && y == tui->cursor.y) {
-        return RYCE_TUI_ERR_NONE;
-    }
-
-    ryce_softreset_controller_internal(tui);
-    RYCE_TuiError err_code = ryce_write_move_internal(tui, x, y);
-    if (err_code != RYCE_TUI_ERR_NONE) {
-        return err_code;
+RYCE_PRIVATE inline RYCE_TuiError ryce_check_rect_internal(const RYCE_Pane *pane, const uint32_t x, const uint32_t y,
+                                                           const uint32_t width, const uint32_t height) {
+    if (x >= pane->view.width || y >= pane->view.height || width > pane->view.width - x ||
+        height > pane->view.height - y) {
+        return RYCE_TUI_ERR_INVALID_COORDINATES;
     }
 
-    tui->cursor.x = x;
-    tui->cursor.y = y;
-    return ryce_print_write_buffer_internal(tui);
+    return RYCE_TUI_ERR_NONE;
 }
 
-RYCE_PUBLIC RYCE_TuiError ryce_clear_pane(RYCE_Pane *pane) {
-    uint32_t x = 0; // X position in flattened buffer.
-    uint32_t y = 0; // Y position in flattened buffer.
+RYCE_PUBLIC RYCE_TuiError ryce_pane_blit(RYCE_Pane *pane, const uint32_t x, const uint32_t y, const uint32_t width,
+                                         const uint32_t height, const RYCE_Glyph *src, const size_t stride) {
+    RYCE_TuiError error = ryce_check_rect_internal(pane, x, y, width, height);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
 
-    for (size_t i = 0; i < RYCE_SCREEN_BUFFER_CAPACITY; i++) {
-        if (pane->ctx->render_mask[i] != pane->id) {
+    const size_t bytes = width * sizeof(RYCE_Glyph);
+    for (uint32_t row = 0; row < height; row++) {
+        RYCE_Glyph *dst = &pane->glyphs[((size_t)(y + row) * pane->view.width) + x];
+        const RYCE_Glyph *src_row = src + (row * stride);
+        if (pane->dirty == pane->ctx->generation) {
+            // Already damaged, overwrite the row.
+            memcpy(dst, src_row, bytes);
             continue;
         }
 
-        if (pane->ctx->update[i].ch == RYCE_EMPTY_CHAR &&
-            pane->ctx->update[i].style.value == RYCE_DEFAULT_STYLE.value) {
-            continue;
+        // Compare fields rather than bytes, glyph padding may be uninitialized.
+        uint32_t first = width;
+        uint32_t last = 0;
+        for (uint32_t col = 0; col < width; col++) {
+            if (dst[col].ch == src_row[col].ch && dst[col].style.value == src_row[col].style.value) {
+                continue;
+            }
+
+            dst[col] = src_row[col];
+            first = col < first ? col : first;
+            last = col;
         }
 
-        x = i % pane->ctx->view.width; // X position in flattened buffer.
-        y = i / pane->ctx->view.width; // Y position in flattened buffer.
-        if (x >= pane->view.x + pane->view.width || y >= pane->view.y + pane->view.height) {
-            // Out of bounds, skip.
-            i = ((y + 1) * pane->view.width) - 1;
+        if (first <= last && first < width) {
+            ryce_damage_pane_internal(pane, x + first, y + row, last - first + 1);
+        }
+    }
+
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PUBLIC RYCE_TuiError ryce_pane_fill(RYCE_Pane *pane, const uint32_t x, const uint32_t y, const uint32_t width,
+                                         const uint32_t height, const RYCE_Glyph *glyph) {
+    RYCE_TuiError error = ryce_check_rect_internal(pane, x, y, width, height);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
+
+    const bool dirty = pane->dirty == pane->ctx->generation;
+    for (uint32_t row = 0; row < height; row++) {
+        RYCE_Glyph *dst = &pane->glyphs[((size_t)(y + row) * pane->view.width) + x];
+        if (dirty) {
+            // Already damaged, overwrite the row.
+            for (uint32_t col = 0; col < width; col++) {
+                dst[col] = *glyph;
+            }
+
             continue;
         }
 
-        // Non-default character, reset to default.
-        pane->ctx->update[i] = RYCE_DEFAULT_GLYPH;
+        // Track the changed columns so the row is only damaged where it differs.
+        uint32_t first = width;
+        uint32_t last = 0;
+        for (uint32_t col = 0; col < width; col++) {
+            if (dst[col].ch == glyph->ch && dst[col].style.value == glyph->style.value) {
+                continue;
+            }
+
+            dst[col] = *glyph;
+            first = col < first ? col : first;
+            last = col;
+        }
+
+        if (first <= last && first < width) {
+            ryce_damage_pane_internal(pane, x + first, y + row, last - first + 1);
+        }
     }
 
     return RYCE_TUI_ERR_NONE;
 }
 
-RYCE_PUBLIC RYCE_TuiError ryce_clear_screen(void) {
-    RYCE_PRINTF(RYCE_CSI "2J" RYCE_CSI "0;0H");
-    if (fflush(stdout) != 0) {
-        return RYCE_TUI_ERR_STDOUT_FLUSH_FAILED;
+RYCE_PUBLIC RYCE_TuiError ryce_pane_scroll(RYCE_Pane *pane, const int32_t dx, const int32_t dy) {
+    if (dx == 0 && dy == 0) {
+        return RYCE_TUI_ERR_NONE;
     }
 
+    // Move the pane's cells.
+    RYCE_TuiContext *tui = pane->ctx;
+    const RYCE_ScrollRegion shift = {.width = pane->view.width, .height = pane->view.height, .dx = dx, .dy = dy};
+    ryce_shift_region_internal(pane->glyphs, pane->view.width, &shift);
+
+    // Record the scroll of the visible part for the next render.
+    const int64_t left = pane->view.x > 0 ? pane->view.x : 0;
+    const int64_t top = pane->view.y > 0 ? pane->view.y : 0;
+    const int64_t right = pane->view.x + pane->view.width;
+    const int64_t bottom = pane->view.y + pane->view.height;
+    if (left < tui->view.width && top < tui->view.height && right > left && bottom > top) {
+        const RYCE_ScrollRegion region = {
+            .x = (uint32_t)left,
+            .y = (uint32_t)top,
+            .width = (uint32_t)((right < tui->view.width ? right : tui->view.width) - left),
+            .height = (uint32_t)((bottom < tui->view.height ? bottom : tui->view.height) - top),
+            .dx = dx,
+            .dy = dy,
+        };
+
+        ryce_merge_scroll_internal(&tui->scroll, &region);
+    }
+
+    ryce_damage_rect_internal(tui, pane->view.x, pane->view.y, pane->view.width, pane->view.height);
+    pane->dirty = tui->generation;
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PUBLIC RYCE_TuiError ryce_pane_mark_dirty(RYCE_Pane *pane) {
+    ryce_damage_rect_internal(pane->ctx, pane->view.x, pane->view.y, pane->view.width, pane->view.height);
+    pane->dirty = pane->ctx->generation;
     return RYCE_TUI_ERR_NONE;
 }
 
+RYCE_PUBLIC RYCE_TuiError ryce_move_cursor(RYCE_TuiContext *tui, int64_t x, int64_t y) {
+    if (atomic_load(&tui->render.running)) {
+        // The render thread owns the write buffer and the cursor.
+        return RYCE_TUI_ERR_RENDER_THREAD_RUNNING;
+    } else if (x == tui->cursor.x && y == tui->cursor.y) {
+        return RYCE_TUI_ERR_NONE;
+    }
+
+    ryce_softreset_controller_internal(tui);
+    RYCE_TuiError err_code = ryce_write_move_internal(tui, x, y);
+    if (err_code != RYCE_TUI_ERR_NONE) {
+        return err_code;
+    }
+
+    tui->cursor.x = x;
+    tui->cursor.y = y;
+    return ryce_print_write_buffer_internal(tui);
+}
+
+RYCE_PUBLIC RYCE_TuiError ryce_clear_pane(RYCE_Pane *pane) {
+    // Row-wise fill of the pane's own contents.
+    return ryce_pane_fill(pane, 0, 0, pane->view.width, pane->view.height, &RYCE_DEFAULT_GLYPH);
+}
+
+RYCE_PUBLIC RYCE_TuiError ryce_clear_screen(RYCE_TuiContext *tui) {
+    if (atomic_load(&tui->render.running)) {
+        return RYCE_TUI_ERR_RENDER_THREAD_RUNNING;
+    }
+
+    const char clear[] = RYCE_CSI_BYTES "2J" RYCE_CSI_BYTES "0;0H";
+    RYCE_TuiError error = ryce_write_control_internal(tui, clear, sizeof(clear) - 1);
+    if (error != RYCE_TUI_ERR_NONE) {
+        return error;
+    }
+
+    // The terminal is blank with the cursor home, redraw every cell on the next render.
+    tui->cursor.x = 0;
+    tui->cursor.y = 0;
+    memset(tui->cache, 0, (size_t)tui->view.width * tui->view.height * sizeof(RYCE_Glyph));
+    for (uint32_t y = 0; y < tui->view.height; y++) {
+        ryce_mark_dirty_internal(tui, 0, y, tui->view.width);
+    }
+
+    return ryce_tui_flush(tui);
+}
+
 #endif // RYCE_TUI_IMPL
 #endif // RYCE_TUI_H
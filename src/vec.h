@@ -19,6 +19,7 @@
 */
 #define RYCE_VEC_H
 
+#include "grid.h" // ryce_morton_encode2, ryce_morton_decode2, ryce_grid_idx
 #include <stddef.h>
 #include <stdint.h>
 
@@ -0,0 +1,602 @@
+#if defined(RYCE_IMPL) && !defined(RYCE_VTERM_IMPL)
+#define RYCE_VTERM_IMPL
+#endif
+#ifndef RYCE_VTERM_H
+/*
+    RyCE VTerm - A single-header, STB-styled in-memory virtual terminal.
+
+    Parses the byte stream written by the TUI back into a grid of glyphs, so renders can be measured and checked
+    without a TTY. Register it with `ryce_tui_set_sink(tui, ryce_vterm_sink, &vterm)`.
+
+    USAGE:
+
+    1) In exactly ONE of your .c or .cpp files, do:
+
+       #define RYCE_VTERM_IMPL
+       #include "vterm.h"
+
+    2) In as many other files as you need, just #include "vterm.h"
+       WITHOUT defining RYCE_VTERM_IMPL.
+
+    3) Compile and link all files together.
+
+    Public API:
+    - Structs:
+        - RYCE_VTerm
+    - Functions:
+        - ryce_init_vterm
+        - ryce_vterm_free
+        - ryce_vterm_feed
+        - ryce_vterm_sink
+        - ryce_vterm_compare
+*/
+#define RYCE_VTERM_H
+
+#include "tui.h"
+#include <stdint.h> // uint32_t, uint64_t
+#include <stdlib.h> // malloc, free
+#include <string.h> // memmove
+
+// ---------------------------------------------------------------------//
+// BEGIN VISIBILITY MACROS
+#ifndef RYCE_PUBLIC_DECL
+#define RYCE_PUBLIC_DECL extern
+#endif // RYCE_PUBLIC
+
+#ifndef RYCE_PUBLIC
+#define RYCE_PUBLIC
+#endif // RYCE_PUBLIC
+
+#ifndef RYCE_PRIVATE
+#if defined(__GNUC__) || defined(__clang__)
+#define RYCE_PRIVATE __attribute__((unused)) static
+#else
+#define RYCE_PRIVATE static
+#endif
+#endif // RYCE_PRIVATE
+
+#ifndef RYCE_UNUSED
+#define RYCE_UNUSED(x) (void)(x)
+#endif // RYCE_UNUSED
+// END VISIBILITY MACROS
+// ---------------------------------------------------------------------//
+
+// Numeric Contants
+enum {
+    RYCE_VTERM_MAX_PARAMS = 16, //< Parameters kept per control sequence, extra ones are dropped.
+};
+
+// Error Codes.
+typedef enum RYCE_VTermError {
+    RYCE_VTERM_ERR_NONE,               ///< No error.
+    RYCE_VTERM_ERR_INVALID_DIMENSIONS, ///< Invalid dimensions.
+    RYCE_VTERM_ERR_ALLOCATE_BUFFER,    ///< Failed to allocate a buffer.
+} RYCE_VTermError;
+
+// Parser States.
+typedef enum RYCE_VTermState {
+    RYCE_VTERM_STATE_GROUND, ///< Printing characters.
+    RYCE_VTERM_STATE_ESCAPE, ///< After ESC.
+    RYCE_VTERM_STATE_CSI,    ///< Inside a control sequence.
+    RYCE_VTERM_STATE_OSC,    ///< Inside an operating system command, ignored until BEL or ST.
+} RYCE_VTermState;
+
+/*
+    Public API Structs
+*/
+
+/**
+ * @brief Screen grid and parser state of a virtual terminal.
+ */
+typedef struct RYCE_VTerm {
+    uint32_t width;  ///< Columns.
+    uint32_t height; ///< Rows.
+    struct {
+        uint32_t x; ///< Column, equal to width while a wrap is pending.
+        uint32_t y; ///< Row.
+    } cursor;
+    struct {
+        uint32_t top;    ///< First row of the scroll region.
+        uint32_t bottom; ///< Last row of the scroll region.
+        uint32_t left;   ///< First column of the scroll region.
+        uint32_t right;  ///< Last column of the scroll region.
+        bool columns;    ///< Left and right margins are enabled (DECLRMM).
+    } margins;
+    RYCE_Style style; ///< Current graphic rendition.
+    RYCE_CHAR last;   ///< Last printed character, repeated by REP.
+    struct {
+        RYCE_VTermState state;                   ///< Current parser state.
+        uint32_t params[RYCE_VTERM_MAX_PARAMS]; ///< Numeric parameters of the current sequence.
+        uint32_t count;                          ///< Parameters seen in the current sequence.
+        char marker;                             ///< Private marker ('?', '>', ...) or '\0'.
+        char intermediate;                       ///< Last intermediate byte or '\0'.
+        uint32_t codepoint;                      ///< UTF-8 character being decoded.
+        uint32_t pending;                        ///< UTF-8 continuation bytes still expected.
+    } parser;
+    struct {
+        uint64_t bytes;     ///< Bytes fed.
+        uint64_t sequences; ///< Control sequences and control characters parsed.
+        uint64_t glyphs;    ///< Characters printed, repeats included.
+    } stats;
+    RYCE_Glyph *grid; ///< Screen contents. [width * height]
+} RYCE_VTerm;
+
+/*
+    Public API Functions.
+*/
+
+/**
+ * @brief Initializes a blank virtual terminal, release it with `ryce_vterm_free`.
+ *
+ * @param width Columns of the terminal.
+ * @param height Rows of the terminal.
+ * @param out Pointer to the virtual terminal to be initialized.
+ * @return RYCE_VTermError RYCE_VTERM_ERR_NONE if successful, otherwise an error code.
+ */
+RYCE_PUBLIC_DECL RYCE_VTermError ryce_init_vterm(uint32_t width, uint32_t height, RYCE_VTerm *out);
+
+/**
+ * @brief Releases the grid of a virtual terminal.
+ *
+ * @param vterm Pointer to the virtual terminal.
+ */
+RYCE_PUBLIC_DECL void ryce_vterm_free(RYCE_VTerm *vterm);
+
+/**
+ * @brief Parses bytes written to the terminal. Sequences may be split across calls.
+ *
+ * @param vterm Pointer to the virtual terminal.
+ * @param buffer Bytes to parse.
+ * @param length Number of bytes.
+ */
+RYCE_PUBLIC_DECL void ryce_vterm_feed(RYCE_VTerm *vterm, const char *buffer, size_t length);
+
+/**
+ * @brief TUI sink feeding a virtual terminal, pass the terminal as `user`.
+ *
+ * @param user Pointer to the virtual terminal.
+ * @param buffer Bytes to parse.
+ * @param length Number of bytes.
+ * @return RYCE_TuiError Always RYCE_TUI_ERR_NONE.
+ */
+RYCE_PUBLIC_DECL RYCE_TuiError ryce_vterm_sink(void *user, const char *buffer, size_t length);
+
+/**
+ * @brief Counts the cells that differ from the expected glyphs.
+ *
+ * @param vterm Pointer to the virtual terminal.
+ * @param expected Glyphs the screen should show, laid out like the grid. [width * height]
+ * @return size_t Number of cells with a different character or style.
+ */
+RYCE_PUBLIC_DECL size_t ryce_vterm_compare(const RYCE_VTerm *vterm, const RYCE_Glyph *expected);
+
+/*===========================================================================
+   ▗▄▄▄▖▗▖  ▗▖▗▄▄▖ ▗▖   ▗▄▄▄▖▗▖  ▗▖▗▄▄▄▖▗▖  ▗▖▗▄▄▄▖ ▗▄▖ ▗▄▄▄▖▗▄▄▄▖ ▗▄▖ ▗▖  ▗▖
+     █  ▐▛▚▞▜▌▐▌ ▐▌▐▌   ▐▌   ▐▛▚▞▜▌▐▌   ▐▛▚▖▐▌  █  ▐▌ ▐▌  █    █  ▐▌ ▐▌▐▛▚▖▐▌
+     █  ▐▌  ▐▌▐▛▀▘ ▐▌   ▐▛▀▀▘▐▌  ▐▌▐▛▀▀▘▐▌ ▝▜▌  █  ▐▛▀▜▌  █    █  ▐▌ ▐▌▐▌ ▝▜▌
+   ▗▄█▄▖▐▌  ▐▌▐▌   ▐▙▄▄▖▐▙▄▄▖▐▌  ▐▌▐▙▄▄▖▐▌  ▐▌  █  ▐▌ ▐▌  █  ▗▄█▄▖▝▚▄▞▘▐▌  ▐▌
+   IMPLEMENTATION
+   Provide function definitions only if RYCE_VTERM_IMPL is defined.
+  ===========================================================================*/
+#ifdef RYCE_VTERM_IMPL
+
+/**
+ * @brief SGR codes toggling the style flags.
+ */
+static const struct {
+    uint16_t bit; // Bitmask for the style flag.
+    uint32_t on;  // SGR code enabling the flag.
+    uint32_t off; // SGR code disabling the flag.
+} VTERM_SGR_MAP[] = {
+    {RYCE_STYLE_MODIFIER_BOLD, 1, 22},   {RYCE_STYLE_MODIFIER_DIM, 2, 22},
+    {RYCE_STYLE_MODIFIER_ITALIC, 3, 23}, {RYCE_STYLE_MODIFIER_UNDERLINE, 4, 24},
+    {RYCE_STYLE_MODIFIER_BLINK, 5, 25},  {RYCE_STYLE_MODIFIER_REVERSE, 7, 27},
+    {RYCE_STYLE_MODIFIER_HIDDEN, 8, 28}, {RYCE_STYLE_MODIFIER_STRIKETHROUGH, 9, 29},
+};
+
+RYCE_PRIVATE inline RYCE_Glyph ryce_vterm_blank_internal(const RYCE_VTerm *vterm) {
+    // Erased cells keep the current background (BCE) and drop everything else.
+    RYCE_Glyph blank = RYCE_DEFAULT_GLYPH;
+    blank.style.part.bg_color = vterm->style.part.bg_color;
+    return blank;
+}
+
+RYCE_PRIVATE inline uint32_t ryce_vterm_param_internal(const RYCE_VTerm *vterm, const uint32_t index,
+                                                       const uint32_t fallback) {
+    // Missing and zero parameters take the sequence's default.
+    if (index >= vterm->parser.count || vterm->parser.params[index] == 0) {
+        return fallback;
+    }
+
+    return vterm->parser.params[index];
+}
+
+RYCE_PRIVATE inline uint32_t ryce_vterm_right_internal(const RYCE_VTerm *vterm) {
+    return vterm->margins.columns ? vterm->margins.right : vterm->width - 1;
+}
+
+RYCE_PRIVATE inline uint32_t ryce_vterm_left_internal(const RYCE_VTerm *vterm) {
+    return vterm->margins.columns ? vterm->margins.left : 0;
+}
+
+RYCE_PRIVATE void ryce_vterm_scroll_internal(RYCE_VTerm *vterm, const int64_t count) {
+    // Positive counts move the region up (SU), negative counts move it down (SD).
+    const uint32_t left = ryce_vterm_left_internal(vterm);
+    const uint32_t right = ryce_vterm_right_internal(vterm);
+    const int64_t rows = (int64_t)vterm->margins.bottom - vterm->margins.top + 1;
+    const RYCE_Glyph blank = ryce_vterm_blank_internal(vterm);
+    for (int64_t i = 0; i < rows; i++) {
+        const int64_t row = count > 0 ? i : rows - 1 - i;
+        const int64_t src = row + count;
+        RYCE_Glyph *dst = &vterm->grid[((vterm->margins.top + row) * vterm->width) + left];
+        if (src < 0 || src >= rows) {
+            for (uint32_t x = 0; x <= right - left; x++) {
+                dst[x] = blank;
+            }
+        } else {
+            memmove(dst, &vterm->grid[((vterm->margins.top + src) * vterm->width) + left],
+                    (right - left + 1) * sizeof(RYCE_Glyph));
+        }
+    }
+}
+
+RYCE_PRIVATE void ryce_vterm_shift_internal(RYCE_VTerm *vterm, const int64_t count) {
+    // Positive counts delete characters at the cursor (DCH), negative counts insert blanks (ICH).
+    const uint32_t right = ryce_vterm_right_internal(vterm);
+    const uint32_t x = vterm->cursor.x < vterm->width ? vterm->cursor.x : vterm->width - 1;
+    if (x > right) {
+        return;
+    }
+
+    const int64_t cells = (int64_t)right - x + 1;
+    const RYCE_Glyph blank = ryce_vterm_blank_internal(vterm);
+    RYCE_Glyph *row = &vterm->grid[(vterm->cursor.y * vterm->width) + x];
+    for (int64_t i = 0; i < cells; i++) {
+        const int64_t col = count > 0 ? i : cells - 1 - i;
+        const int64_t src = col + count;
+        row[col] = src < 0 || src >= cells ? blank : row[src];
+    }
+}
+
+RYCE_PRIVATE void ryce_vterm_line_feed_internal(RYCE_VTerm *vterm) {
+    if (vterm->cursor.y == vterm->margins.bottom) {
+        ryce_vterm_scroll_internal(vterm, 1);
+    } else if (vterm->cursor.y + 1 < vterm->height) {
+        vterm->cursor.y++;
+    }
+}
+
+RYCE_PRIVATE void ryce_vterm_print_internal(RYCE_VTerm *vterm, const RYCE_CHAR ch) {
+    if (vterm->cursor.x >= vterm->width) {
+        // Pending wrap, continue on the next line.
+        vterm->cursor.x = 0;
+        ryce_vterm_line_feed_internal(vterm);
+    }
+
+    vterm->grid[(vterm->cursor.y * vterm->width) + vterm->cursor.x] = (RYCE_Glyph){.ch = ch, .style = vterm->style};
+    vterm->cursor.x++;
+    vterm->last = ch;
+    vterm->stats.glyphs++;
+}
+
+RYCE_PRIVATE void ryce_vterm_erase_internal(RYCE_VTerm *vterm, const size_t start, const size_t end) {
+    // Blank the cells in [start, end) of the flattened grid.
+    const RYCE_Glyph blank = ryce_vterm_blank_internal(vterm);
+    for (size_t i = start; i < end; i++) {
+        vterm->grid[i] = blank;
+    }
+}
+
+RYCE_PRIVATE void ryce_vterm_sgr_internal(RYCE_VTerm *vterm) {
+    const uint32_t count = vterm->parser.count > 0 ? vterm->parser.count : 1;
+    for (uint32_t i = 0; i < count; i++) {
+        const uint32_t code = i < vterm->parser.count ? vterm->parser.params[i] : 0;
+        if (code == 0) {
+            vterm->style = RYCE_DEFAULT_STYLE;
+        } else if (code >= 30 && code <= 37) {
+            vterm->style.part.fg_color = (uint8_t)(code - 29);
+        } else if (code == 39) {
+            vterm->style.part.fg_color = RYCE_STYLE_COLOR_DEFAULT;
+        } else if (code >= 40 && code <= 47) {
+            vterm->style.part.bg_color = (uint8_t)(code - 39);
+        } else if (code == 49) {
+            vterm->style.part.bg_color = RYCE_STYLE_COLOR_DEFAULT;
+        }
+
+        for (size_t j = 0; j < sizeof(VTERM_SGR_MAP) / sizeof(VTERM_SGR_MAP[0]); j++) {
+            if (code == VTERM_SGR_MAP[j].on) {
+                vterm->style.part.style_flags |= VTERM_SGR_MAP[j].bit;
+            } else if (code == VTERM_SGR_MAP[j].off) {
+                vterm->style.part.style_flags &= (uint16_t)~VTERM_SGR_MAP[j].bit;
+            }
+        }
+    }
+}
+
+RYCE_PRIVATE void ryce_vterm_dispatch_internal(RYCE_VTerm *vterm, const char final) {
+    const uint32_t n = ryce_vterm_param_internal(vterm, 0, 1);
+    const size_t row = (size_t)vterm->cursor.y * vterm->width;
+    const uint32_t x = vterm->cursor.x < vterm->width ? vterm->cursor.x : vterm->width - 1;
+    vterm->stats.sequences++;
+
+    if (vterm->parser.marker == '?') {
+        // Only left and right margin mode changes what is drawn.
+        if ((final == 'h' || final == 'l') && ryce_vterm_param_internal(vterm, 0, 0) == 69) {
+            vterm->margins.columns = final == 'h';
+            vterm->margins.left = 0;
+            vterm->margins.right = vterm->width - 1;
+        }
+
+        return;
+    } else if (vterm->parser.marker != '\0' || vterm->parser.intermediate != '\0') {
+        return;
+    }
+
+    switch (final) {
+    case 'H':
+    case 'f': {
+        const uint32_t y = ryce_vterm_param_internal(vterm, 0, 1);
+        const uint32_t col = ryce_vterm_param_internal(vterm, 1, 1);
+        vterm->cursor.y = y <= vterm->height ? y - 1 : vterm->height - 1;
+        vterm->cursor.x = col <= vterm->width ? col - 1 : vterm->width - 1;
+        break;
+    }
+    case 'A':
+        vterm->cursor.y = vterm->cursor.y > n ? vterm->cursor.y - n : 0;
+        vterm->cursor.x = x;
+        break;
+    case 'B':
+        vterm->cursor.y = vterm->cursor.y + n < vterm->height ? vterm->cursor.y + n : vterm->height - 1;
+        vterm->cursor.x = x;
+        break;
+    case 'C':
+        vterm->cursor.x = x + n < vterm->width ? x + n : vterm->width - 1;
+        break;
+    case 'D':
+        vterm->cursor.x = x > n ? x - n : 0;
+        break;
+    case 'G':
+        vterm->cursor.x = n <= vterm->width ? n - 1 : vterm->width - 1;
+        break;
+    case 'd':
+        vterm->cursor.y = n <= vterm->height ? n - 1 : vterm->height - 1;
+        vterm->cursor.x = x;
+        break;
+    case 'J': {
+        const uint32_t mode = ryce_vterm_param_internal(vterm, 0, 0);
+        const size_t cells = (size_t)vterm->width * vterm->height;
+        ryce_vterm_erase_internal(vterm, mode == 0 ? row + x : 0, mode == 1 ? row + x + 1 : cells);
+        break;
+    }
+    case 'K': {
+        const uint32_t mode = ryce_vterm_param_internal(vterm, 0, 0);
+        ryce_vterm_erase_internal(vterm, mode == 0 ? row + x : row, mode == 1 ? row + x + 1 : row + vterm->width);
+        break;
+    }
+    case 'X':
+        ryce_vterm_erase_internal(vterm, row + x, row + (x + n < vterm->width ? x + n : vterm->width));
+        break;
+    case 'b':
+        for (uint32_t i = 0; i < n; i++) {
+            ryce_vterm_print_internal(vterm, vterm->last);
+        }
+        break;
+    case 'S':
+        ryce_vterm_scroll_internal(vterm, n);
+        break;
+    case 'T':
+        ryce_vterm_scroll_internal(vterm, -(int64_t)n);
+        break;
+    case 'P':
+        ryce_vterm_shift_internal(vterm, n);
+        break;
+    case '@':
+        ryce_vterm_shift_internal(vterm, -(int64_t)n);
+        break;
+    case 'r': {
+        const uint32_t top = ryce_vterm_param_internal(vterm, 0, 1);
+        const uint32_t bottom = ryce_vterm_param_internal(vterm, 1, vterm->height);
+        if (top < bottom && bottom <= vterm->height) {
+            vterm->margins.top = top - 1;
+            vterm->margins.bottom = bottom - 1;
+            vterm->cursor.x = 0;
+            vterm->cursor.y = 0;
+        }
+        break;
+    }
+    case 's': {
+        // DECSLRM while margins are enabled, otherwise a cursor save which does not change the grid.
+        const uint32_t left = ryce_vterm_param_internal(vterm, 0, 1);
+        const uint32_t right = ryce_vterm_param_internal(vterm, 1, vterm->width);
+        if (vterm->margins.columns && left < right && right <= vterm->width) {
+            vterm->margins.left = left - 1;
+            vterm->margins.right = right - 1;
+            vterm->cursor.x = 0;
+            vterm->cursor.y = 0;
+        }
+        break;
+    }
+    case 'm':
+        ryce_vterm_sgr_internal(vterm);
+        break;
+    default:
+        // Unsupported sequences do not change the grid.
+        break;
+    }
+}
+
+RYCE_PRIVATE void ryce_vterm_control_internal(RYCE_VTerm *vterm, const uint32_t ch) {
+    switch (ch) {
+    case '\r':
+        vterm->cursor.x = 0;
+        break;
+    case '\n':
+        ryce_vterm_line_feed_internal(vterm);
+        break;
+    case '\b':
+        vterm->cursor.x = vterm->cursor.x > 0 ? vterm->cursor.x - 1 : 0;
+        break;
+    default:
+        return;
+    }
+
+    vterm->stats.sequences++;
+}
+
+RYCE_PRIVATE void ryce_vterm_begin_csi_internal(RYCE_VTerm *vterm) {
+    vterm->parser.state = RYCE_VTERM_STATE_CSI;
+    vterm->parser.count = 0;
+    vterm->parser.marker = '\0';
+    vterm->parser.intermediate = '\0';
+    memset(vterm->parser.params, 0, sizeof(vterm->parser.params));
+}
+
+RYCE_PRIVATE void ryce_vterm_step_internal(RYCE_VTerm *vterm, const uint32_t ch) {
+    switch (vterm->parser.state) {
+    case RYCE_VTERM_STATE_GROUND:
+        if (ch == 0x1B) {
+            vterm->parser.state = RYCE_VTERM_STATE_ESCAPE;
+        } else if (ch == 0x9B) {
+            ryce_vterm_begin_csi_internal(vterm);
+        } else if (ch < 0x20 || ch == 0x7F || (ch >= 0x80 && ch < 0xA0)) {
+            ryce_vterm_control_internal(vterm, ch);
+        } else {
+            ryce_vterm_print_internal(vterm, (RYCE_CHAR)ch);
+        }
+        break;
+    case RYCE_VTERM_STATE_ESCAPE:
+        if (ch == '[') {
+            ryce_vterm_begin_csi_internal(vterm);
+        } else if (ch == ']') {
+            vterm->parser.state = RYCE_VTERM_STATE_OSC;
+        } else {
+            // Other escapes are a single character long and ignored.
+            vterm->stats.sequences++;
+            vterm->parser.state = RYCE_VTERM_STATE_GROUND;
+        }
+        break;
+    case RYCE_VTERM_STATE_CSI:
+        if (ch >= '0' && ch <= '9') {
+            if (vterm->parser.count == 0) {
+                vterm->parser.count = 1;
+            }
+
+            uint32_t *param = &vterm->parser.params[vterm->parser.count - 1];
+            *param = (*param * 10) + (ch - '0');
+        } else if (ch == ';') {
+            // An empty first parameter still counts.
+            vterm->parser.count = vterm->parser.count == 0 ? 2 : vterm->parser.count + 1;
+            if (vterm->parser.count > RYCE_VTERM_MAX_PARAMS) {
+                vterm->parser.count = RYCE_VTERM_MAX_PARAMS;
+            }
+        } else if (ch >= 0x3C && ch <= 0x3F) {
+            vterm->parser.marker = (char)ch;
+        } else if (ch >= 0x20 && ch <= 0x2F) {
+            vterm->parser.intermediate = (char)ch;
+        } else if (ch >= 0x40 && ch <= 0x7E) {
+            ryce_vterm_dispatch_internal(vterm, (char)ch);
+            vterm->parser.state = RYCE_VTERM_STATE_GROUND;
+        } else {
+            // Malformed sequence, drop it.
+            vterm->parser.state = RYCE_VTERM_STATE_GROUND;
+        }
+        break;
+    case RYCE_VTERM_STATE_OSC:
+        if (ch == 0x07 || ch == 0x9C) {
+            vterm->stats.sequences++;
+            vterm->parser.state = RYCE_VTERM_STATE_GROUND;
+        } else if (ch == 0x1B) {
+            // ESC \ terminates the command, the backslash is swallowed by the escape state.
+            vterm->stats.sequences++;
+            vterm->parser.state = RYCE_VTERM_STATE_ESCAPE;
+        }
+        break;
+    }
+}
+
+RYCE_PUBLIC RYCE_VTermError ryce_init_vterm(const uint32_t width, const uint32_t height, RYCE_VTerm *out) {
+    if (width == 0 || height == 0) {
+        return RYCE_VTERM_ERR_INVALID_DIMENSIONS;
+    }
+
+    *out = (RYCE_VTerm){
+        .width = width,
+        .height = height,
+        .margins = {.top = 0, .bottom = height - 1, .left = 0, .right = width - 1, .columns = false},
+        .style = RYCE_DEFAULT_STYLE,
+        .last = RYCE_EMPTY_CHAR,
+        .parser = {.state = RYCE_VTERM_STATE_GROUND},
+    };
+
+    const size_t cells = (size_t)width * height;
+    out->grid = (RYCE_Glyph *)malloc(cells * sizeof(RYCE_Glyph));
+    if (out->grid == nullptr) {
+        return RYCE_VTERM_ERR_ALLOCATE_BUFFER;
+    }
+
+    for (size_t i = 0; i < cells; i++) {
+        out->grid[i] = RYCE_DEFAULT_GLYPH;
+    }
+
+    return RYCE_VTERM_ERR_NONE;
+}
+
+RYCE_PUBLIC void ryce_vterm_free(RYCE_VTerm *vterm) {
+    free(vterm->grid);
+    vterm->grid = nullptr;
+}
+
+RYCE_PUBLIC void ryce_vterm_feed(RYCE_VTerm *vterm, const char *buffer, const size_t length) {
+    vterm->stats.bytes += length;
+    for (size_t i = 0; i < length; i++) {
+        const uint8_t byte = (uint8_t)buffer[i];
+#ifdef RYCE_WIDE_CHAR_SUPPORT
+        // Decode UTF-8, malformed bytes restart the decoder.
+        if (vterm->parser.pending > 0 && (byte & 0xC0) == 0x80) {
+            vterm->parser.codepoint = (vterm->parser.codepoint << 6) | (byte & 0x3F);
+            if (--vterm->parser.pending == 0) {
+                ryce_vterm_step_internal(vterm, vterm->parser.codepoint);
+            }
+
+            continue;
+        }
+
+        vterm->parser.pending = 0;
+        if (byte >= 0xF0) {
+            vterm->parser.codepoint = byte & 0x07;
+            vterm->parser.pending = 3;
+        } else if (byte >= 0xE0) {
+            vterm->parser.codepoint = byte & 0x0F;
+            vterm->parser.pending = 2;
+        } else if (byte >= 0xC0) {
+            vterm->parser.codepoint = byte & 0x1F;
+            vterm->parser.pending = 1;
+        } else {
+            ryce_vterm_step_internal(vterm, byte);
+        }
+#else
+        // Narrow output is written byte for byte.
+        ryce_vterm_step_internal(vterm, byte);
+#endif
+    }
+}
+
+RYCE_PUBLIC RYCE_TuiError ryce_vterm_sink(void *user, const char *buffer, const size_t length) {
+    ryce_vterm_feed((RYCE_VTerm *)user, buffer, length);
+    return RYCE_TUI_ERR_NONE;
+}
+
+RYCE_PUBLIC size_t ryce_vterm_compare(const RYCE_VTerm *vterm, const RYCE_Glyph *expected) {
+    size_t mismatches = 0;
+    const size_t cells = (size_t)vterm->width * vterm->height;
+    for (size_t i = 0; i < cells; i++) {
+        if (vterm->grid[i].ch != expected[i].ch || vterm->grid[i].style.value != expected[i].style.value) {
+            mismatches++;
+        }
+    }
+
+    return mismatches;
+}
+
+#endif // RYCE_VTERM_IMPL
+#endif // RYCE_VTERM_H